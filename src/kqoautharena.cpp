@@ -0,0 +1,93 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include <QByteArray>
+
+#include "kqoautharena_p.h"
+
+KQOAuthArena::KQOAuthArena() :
+    current(inlineBlock.data),
+    remaining(InlineSize)
+{
+}
+
+KQOAuthArena::~KQOAuthArena()
+{
+    release();
+}
+
+void *KQOAuthArena::allocate(int size) {
+    Q_ASSERT(size >= 0);
+    const int alignedSize = (size + Alignment - 1) & ~(Alignment - 1);
+
+    // What is left of the current block is given up. Requests with large parameters get a
+    // block of their own.
+    if (alignedSize > remaining) {
+        const int blockSize = qMax(int(BlockSize), alignedSize);
+        char *block = static_cast<char *>(::malloc(blockSize));
+        Q_CHECK_PTR(block);
+        heapBlocks.append(block);
+        current = block;
+        remaining = blockSize;
+    }
+
+    void *result = current;
+    current += alignedSize;
+    remaining -= alignedSize;
+    return result;
+}
+
+// Plain ASCII strings, which nearly all OAuth parameters are, are narrowed straight from the
+// QString without a temporary QByteArray.
+const char *KQOAuthArena::utf8(const QString &string, int *length) {
+    const ushort *data = string.utf16();
+    const int size = string.size();
+    for (int i = 0; i < size; i++) {
+        if (data[i] >= 0x80) {
+            const QByteArray utf8 = string.toUtf8();
+            char *out = allocate<char>(utf8.size());
+            memcpy(out, utf8.constData(), utf8.size());
+            *length = utf8.size();
+            return out;
+        }
+    }
+
+    char *out = allocate<char>(size);
+    for (int i = 0; i < size; i++) {
+        out[i] = char(data[i]);
+    }
+    *length = size;
+    return out;
+}
+
+void KQOAuthArena::release() {
+    for (int i = 0; i < heapBlocks.size(); i++) {
+        ::free(heapBlocks[i]);
+    }
+    heapBlocks.resize(0);
+    current = inlineBlock.data;
+    remaining = InlineSize;
+}
+
+int KQOAuthArena::heapBlockCount() const {
+    return heapBlocks.size();
+}
@@ -0,0 +1,74 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHARENA_P_H
+#define KQOAUTHARENA_P_H
+
+#include <QString>
+#include <QVarLengthArray>
+
+#include "kqoauthglobals.h"
+
+/**
+ * Scratch memory for signing one request. Allocations are taken from a block one after the
+ * other and are never freed one by one; release() gives all of them back in one step. The
+ * first block is part of the arena itself, so an arena on the stack signs a typical request
+ * without touching the heap. Only plain data can be allocated from it.
+ */
+class KQOAUTH_EXPORT KQOAuthArena
+{
+public:
+    enum {
+        InlineSize = 4096,
+        BlockSize = 16 * 1024,
+        Alignment = 8
+    };
+
+    KQOAuthArena();
+    ~KQOAuthArena();
+
+    // 'size' bytes, aligned for pointers and doubles. Valid until release().
+    void *allocate(int size);
+    template <typename T> T *allocate(int count) {
+        return static_cast<T *>(allocate(count * int(sizeof(T))));
+    }
+
+    // The UTF-8 form of 'string', copied into the arena. It is not null terminated.
+    const char *utf8(const QString &string, int *length);
+
+    // Frees the blocks taken from the heap and starts again from the first one.
+    void release();
+    // The number of blocks taken from the heap since the last release().
+    int heapBlockCount() const;
+
+private:
+    Q_DISABLE_COPY(KQOAuthArena);
+
+    union {
+        char data[InlineSize];
+        double alignment;
+        void *pointer;
+    } inlineBlock;
+    QVarLengthArray<char *, 4> heapBlocks;
+    char *current;
+    int remaining;
+};
+
+#endif // KQOAUTHARENA_P_H
@@ -0,0 +1,354 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include <QtAlgorithms>
+
+#include "kqoauthbasestring_p.h"
+#include "kqoauthpercentencoder_p.h"
+#include "kqoautharena_p.h"
+#include "kqoauthinterntable_p.h"
+
+namespace {
+
+// One parameter, percent encoded once. Parameters from a KQOAuthEncodedParameters set also
+// point to their finished "key%3Dvalue" segment, which is copied as is.
+struct EncodedParameter {
+    const char *key;
+    int keyLength;
+    const char *value;
+    int valueLength;
+    const char *segment;
+    int segmentLength;
+};
+
+// http://oauth.net/core/1.0/#rfc.section.9.1.1 Parameters are sorted by name using
+// lexicographical byte value ordering, and parameters with the same name by their value.
+// The comparison is done on the encoded bytes where they are, without copying them.
+class EncodedParameterLessThan
+{
+public:
+    bool operator()(const EncodedParameter &left, const EncodedParameter &right) const {
+        const int keyOrder = compare(left.key, left.keyLength, right.key, right.keyLength);
+        if (keyOrder != 0) {
+            return keyOrder < 0;
+        }
+        return compare(left.value, left.valueLength, right.value, right.valueLength) < 0;
+    }
+
+private:
+    static int compare(const char *left, int leftLength, const char *right, int rightLength) {
+        const int order = memcmp(left, right, qMin(leftLength, rightLength));
+        if (order != 0) {
+            return order;
+        }
+        return leftLength - rightLength;
+    }
+};
+
+}
+
+// The UTF-8 form of 'string' percent encoded once, written to 'arena'. Short strings are
+// taken from 'internTable', if there is one.
+static const char *encodeText(KQOAuthArena &arena, const QString &string, int *encodedLength,
+                              KQOAuthInternTable *internTable) {
+    if (internTable != 0 && string.size() <= KQOAuthInternTable::MaxLength) {
+        const QByteArray interned = internTable->encoded(string);
+        *encodedLength = interned.size();
+        char *encoded = arena.allocate<char>(*encodedLength);
+        memcpy(encoded, interned.constData(), *encodedLength);
+        return encoded;
+    }
+
+    int length;
+    const char *utf8 = arena.utf8(string, &length);
+    *encodedLength = KQOAuthPercentEncoder::encodedLength(utf8, length);
+    char *encoded = arena.allocate<char>(*encodedLength);
+    KQOAuthPercentEncoder::encode(encoded, utf8, length);
+    return encoded;
+}
+
+// Percent encodes the keys and values of 'first' and then 'second' once, into 'arena'.
+static void encodeParameters(KQOAuthArena &arena, const KQOAuthParameterList &first,
+                             const KQOAuthParameterList &second, EncodedParameter *out,
+                             KQOAuthInternTable *internTable = 0) {
+    const int firstCount = first.size();
+    const int count = firstCount + second.size();
+
+    for (int i = 0; i < count; i++) {
+        const KQOAuthParameterList::Parameter &source = (i < firstCount) ? first.at(i)
+                                                                         : second.at(i - firstCount);
+        EncodedParameter &parameter = out[i];
+        parameter.key = encodeText(arena, source.first, &parameter.keyLength, internTable);
+        parameter.value = encodeText(arena, source.second, &parameter.valueLength, internTable);
+        parameter.segment = 0;
+        parameter.segmentLength = 0;
+    }
+}
+
+// Merges two sorted runs into 'out'. Equal parameters from 'first' come before those from 'second'.
+static void mergeParameters(const EncodedParameter *first, int firstCount,
+                            const EncodedParameter *second, int secondCount, EncodedParameter *out) {
+    const EncodedParameterLessThan lessThan;
+    int left = 0;
+    int right = 0;
+    for (int i = 0; i < firstCount + secondCount; i++) {
+        if (right == secondCount || (left < firstCount && !lessThan(second[right], first[left]))) {
+            out[i] = first[left++];
+        } else {
+            out[i] = second[right++];
+        }
+    }
+}
+
+KQOAuthEncodedParameters::KQOAuthEncodedParameters()
+{
+}
+
+KQOAuthEncodedParameters::KQOAuthEncodedParameters(const KQOAuthParameterList &parameters) {
+    append(parameters);
+}
+
+KQOAuthEncodedParameters::KQOAuthEncodedParameters(const KQOAuthEncodedParameters &encodedParameters,
+                                                   const KQOAuthParameterList &parameters,
+                                                   KQOAuthInternTable *internTable) :
+    encoded(encodedParameters.encoded),
+    segments(encodedParameters.segments),
+    formEncoded(encodedParameters.formEncoded),
+    parameters(encodedParameters.parameters)
+{
+    append(parameters, internTable);
+}
+
+// Encodes 'parameters' once and merges them with the ones there already, which are only
+// compared, not encoded again.
+void KQOAuthEncodedParameters::append(const KQOAuthParameterList &parameters,
+                                      KQOAuthInternTable *internTable) {
+    const int count = parameters.size();
+    if (count == 0) {
+        return;
+    }
+
+    KQOAuthArena arena;
+    EncodedParameter *added = arena.allocate<EncodedParameter>(count);
+    encodeParameters(arena, KQOAuthParameterList(), parameters, added, internTable);
+
+    // The form keeps the order the parameters were given in.
+    int formLength = formEncoded.size() + (formEncoded.isEmpty() ? count - 1 : count);
+    int encodedLength = encoded.size();
+    for (int i = 0; i < count; i++) {
+        formLength += added[i].keyLength + 1 + added[i].valueLength;
+        encodedLength += added[i].keyLength + added[i].valueLength;
+    }
+    formEncoded.reserve(formLength);
+    for (int i = 0; i < count; i++) {
+        if (!formEncoded.isEmpty()) {
+            formEncoded.append('&');
+        }
+        formEncoded.append(added[i].key, added[i].keyLength);
+        formEncoded.append('=');
+        formEncoded.append(added[i].value, added[i].valueLength);
+    }
+
+    qSort(added, added + count, EncodedParameterLessThan());
+
+    // Keys and values are kept encoded once for merging, and each "key%3Dvalue" encoded a
+    // second time, the way it is written to the base string.
+    Parameter *records = arena.allocate<Parameter>(count);
+    encoded.reserve(encodedLength);
+    for (int i = 0; i < count; i++) {
+        const EncodedParameter &source = added[i];
+        Parameter &parameter = records[i];
+
+        parameter.key = encoded.size();
+        parameter.keyLength = source.keyLength;
+        encoded.append(source.key, source.keyLength);
+        parameter.value = encoded.size();
+        parameter.valueLength = source.valueLength;
+        encoded.append(source.value, source.valueLength);
+
+        parameter.segment = segments.size();
+        parameter.segmentLength = KQOAuthPercentEncoder::encodedLength(source.key, source.keyLength) + 3
+                + KQOAuthPercentEncoder::encodedLength(source.value, source.valueLength);
+        segments.resize(parameter.segment + parameter.segmentLength);
+        char *out = segments.data() + parameter.segment;
+        out = KQOAuthPercentEncoder::encode(out, source.key, source.keyLength);
+        memcpy(out, "%3D", 3);
+        out += 3;
+        KQOAuthPercentEncoder::encode(out, source.value, source.valueLength);
+    }
+
+    // Both runs are sorted, so they are merged. Equal parameters that were there already
+    // come first.
+    const int previousCount = this->parameters.size();
+    QVector<Parameter> merged;
+    merged.reserve(previousCount + count);
+    const EncodedParameterLessThan lessThan;
+    const char *bytes = encoded.constData();
+    int left = 0;
+    int right = 0;
+    while (left < previousCount || right < count) {
+        bool takeLeft = right == count;
+        if (!takeLeft && left < previousCount) {
+            const Parameter &previous = this->parameters.at(left);
+            const Parameter &next = records[right];
+            const EncodedParameter previousView = { bytes + previous.key, previous.keyLength,
+                                                    bytes + previous.value, previous.valueLength, 0, 0 };
+            const EncodedParameter nextView = { bytes + next.key, next.keyLength,
+                                                bytes + next.value, next.valueLength, 0, 0 };
+            takeLeft = !lessThan(nextView, previousView);
+        }
+        merged.append(takeLeft ? this->parameters.at(left++) : records[right++]);
+    }
+    this->parameters = merged;
+}
+
+int KQOAuthEncodedParameters::size() const {
+    return parameters.size();
+}
+
+bool KQOAuthEncodedParameters::isEmpty() const {
+    return parameters.isEmpty();
+}
+
+QByteArray KQOAuthEncodedParameters::form() const {
+    return formEncoded;
+}
+
+QByteArray KQOAuthBaseStringBuilder::prefix(const QString &httpMethod, const QString &endpoint) {
+    const QByteArray method = httpMethod.toUtf8();
+    const QByteArray endpointUtf8 = endpoint.toUtf8();
+
+    QByteArray result;
+    result.resize(method.size() + 1
+                  + KQOAuthPercentEncoder::encodedLength(endpointUtf8.constData(), endpointUtf8.size()) + 1);
+    char *out = result.data();
+    memcpy(out, method.constData(), method.size());
+    out += method.size();
+    *out++ = '&';
+    out = KQOAuthPercentEncoder::encode(out, endpointUtf8.constData(), endpointUtf8.size());
+    *out++ = '&';
+
+    Q_ASSERT(out == result.constData() + result.size());
+    return result;
+}
+
+QByteArray KQOAuthBaseStringBuilder::build(const QString &httpMethod, const QString &endpoint,
+                                           const KQOAuthParameterList &parameters) {
+    KQOAuthArena arena;
+    int length;
+    const char *baseString = build(arena, &length, prefix(httpMethod, endpoint), KQOAuthEncodedParameters(),
+                                   KQOAuthEncodedParameters(), KQOAuthParameterList(), parameters);
+    return QByteArray(baseString, length);
+}
+
+const char *KQOAuthBaseStringBuilder::build(KQOAuthArena &arena, int *length,
+                                            const QByteArray &prefix,
+                                            const KQOAuthEncodedParameters &fixedParameters,
+                                            const KQOAuthEncodedParameters &encodedParameters,
+                                            const KQOAuthParameterList &sortedParameters,
+                                            const KQOAuthParameterList &parameters) {
+    const int sortedCount = sortedParameters.size();
+    const int count = sortedCount + parameters.size();
+
+    // Every key and value is encoded once, and then sorted on those bytes.
+    EncodedParameter *requestParameters = arena.allocate<EncodedParameter>(count);
+    encodeParameters(arena, sortedParameters, parameters, requestParameters);
+
+    // Only the parameters that are not in order yet go through the sort. Both runs are then
+    // merged, and the result merged with the parameters that were sorted when they were
+    // encoded.
+    const EncodedParameter *presorted = requestParameters;
+    EncodedParameter *unsorted = requestParameters + sortedCount;
+    qSort(unsorted, requestParameters + count, EncodedParameterLessThan());
+#ifndef QT_NO_DEBUG
+    for (int i = 1; i < sortedCount; i++) {
+        Q_ASSERT(!EncodedParameterLessThan()(presorted[i], presorted[i - 1]));
+    }
+#endif
+
+    const KQOAuthEncodedParameters *encodedSets[] = { &fixedParameters, &encodedParameters };
+    EncodedParameter *encodedRuns[2];
+    int baseStringLength = prefix.size();
+    for (int set = 0; set < 2; set++) {
+        const KQOAuthEncodedParameters &source = *encodedSets[set];
+        const int setCount = source.parameters.size();
+        encodedRuns[set] = arena.allocate<EncodedParameter>(setCount);
+        for (int i = 0; i < setCount; i++) {
+            const KQOAuthEncodedParameters::Parameter &sourceParameter = source.parameters.at(i);
+            EncodedParameter &parameter = encodedRuns[set][i];
+            parameter.key = source.encoded.constData() + sourceParameter.key;
+            parameter.keyLength = sourceParameter.keyLength;
+            parameter.value = source.encoded.constData() + sourceParameter.value;
+            parameter.valueLength = sourceParameter.valueLength;
+            parameter.segment = source.segments.constData() + sourceParameter.segment;
+            parameter.segmentLength = sourceParameter.segmentLength;
+            baseStringLength += sourceParameter.segmentLength;
+        }
+    }
+    const int fixedCount = fixedParameters.size();
+    const int encodedCount = encodedParameters.size();
+    EncodedParameter *encoded = arena.allocate<EncodedParameter>(fixedCount + encodedCount);
+    mergeParameters(encodedRuns[0], fixedCount, encodedRuns[1], encodedCount, encoded);
+
+    EncodedParameter *merged = arena.allocate<EncodedParameter>(count);
+    mergeParameters(presorted, sortedCount, unsorted, count - sortedCount, merged);
+    const int sortedSize = fixedCount + encodedCount + count;
+    EncodedParameter *sorted = arena.allocate<EncodedParameter>(sortedSize);
+    mergeParameters(encoded, fixedCount + encodedCount, merged, count, sorted);
+
+    // The prefix, then "key%3Dvalue" joined with "%26". Encoding the encoded parameters
+    // again only turns '%' into "%25".
+    for (int i = 0; i < count; i++) {
+        const EncodedParameter &parameter = merged[i];
+        baseStringLength += KQOAuthPercentEncoder::encodedLength(parameter.key, parameter.keyLength) + 3
+                + KQOAuthPercentEncoder::encodedLength(parameter.value, parameter.valueLength);
+    }
+    if (sortedSize > 0) {
+        baseStringLength += 3 * (sortedSize - 1);
+    }
+
+    char *baseString = arena.allocate<char>(baseStringLength);
+    char *out = baseString;
+
+    memcpy(out, prefix.constData(), prefix.size());
+    out += prefix.size();
+
+    for (int i = 0; i < sortedSize; i++) {
+        const EncodedParameter &parameter = sorted[i];
+        if (i > 0) {
+            memcpy(out, "%26", 3);
+            out += 3;
+        }
+        if (parameter.segment) {
+            memcpy(out, parameter.segment, parameter.segmentLength);
+            out += parameter.segmentLength;
+            continue;
+        }
+        out = KQOAuthPercentEncoder::encode(out, parameter.key, parameter.keyLength);
+        memcpy(out, "%3D", 3);
+        out += 3;
+        out = KQOAuthPercentEncoder::encode(out, parameter.value, parameter.valueLength);
+    }
+
+    Q_ASSERT(out == baseString + baseStringLength);
+    *length = baseStringLength;
+    return baseString;
+}
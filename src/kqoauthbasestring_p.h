@@ -0,0 +1,109 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHBASESTRING_P_H
+#define KQOAUTHBASESTRING_P_H
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include "kqoauthglobals.h"
+#include "kqoauthparameterlist_p.h"
+
+class KQOAuthArena;
+class KQOAuthInternTable;
+
+/**
+ * Parameters percent encoded and sorted once. The base string builder merges them with the
+ * parameters of each request and copies their encoded "key%3Dvalue" segments as they are.
+ * The same encoding joined as "key=value&key=value", in the order the parameters were
+ * given, is the form body or URL query that carries them.
+ */
+class KQOAUTH_EXPORT KQOAuthEncodedParameters
+{
+public:
+    KQOAuthEncodedParameters();
+    explicit KQOAuthEncodedParameters(const KQOAuthParameterList &parameters);
+    // 'encoded' followed by 'parameters'. Only 'parameters' are encoded, the others are copied.
+    // Keys and values found in 'internTable' are copied from it too.
+    KQOAuthEncodedParameters(const KQOAuthEncodedParameters &encoded, const KQOAuthParameterList &parameters,
+                             KQOAuthInternTable *internTable = 0);
+
+    int size() const;
+    bool isEmpty() const;
+    QByteArray form() const;
+
+private:
+    void append(const KQOAuthParameterList &parameters, KQOAuthInternTable *internTable = 0);
+
+    // Offsets of the once encoded key and value in 'encoded' and of the segment in 'segments'.
+    struct Parameter {
+        int key;
+        int keyLength;
+        int value;
+        int valueLength;
+        int segment;
+        int segmentLength;
+    };
+
+    QByteArray encoded;
+    QByteArray segments;
+    QByteArray formEncoded;
+    // In sorted order.
+    QVector<Parameter> parameters;
+
+    friend class KQOAuthBaseStringBuilder;
+};
+
+/**
+ * Builds the signature base string, http://oauth.net/core/1.0/#anchor14
+ *
+ * The method is copied as is, the endpoint is percent encoded once and the parameters are
+ * percent encoded, sorted, joined with '=' and '&' and then percent encoded again. Parameters
+ * are encoded once and sorted on those bytes as the spec requires. The exact length is then
+ * computed, so the result is written into one buffer in a single pass.
+ */
+class KQOAUTH_EXPORT KQOAuthBaseStringBuilder
+{
+public:
+    // Writes the base string to 'arena', along with everything used to build it. Returns the
+    // base string, which is not null terminated, and its length in 'length'. 'prefix' is
+    // "METHOD&" + encoded endpoint + "&" from prefix(). 'fixedParameters' and 'encodedParameters',
+    // such as the form parameters of a request, are merged in without encoding them again.
+    // 'sortedParameters' are already in normalized order and 'parameters' can be in any order.
+    static const char *build(KQOAuthArena &arena, int *length,
+                             const QByteArray &prefix,
+                             const KQOAuthEncodedParameters &fixedParameters = KQOAuthEncodedParameters(),
+                             const KQOAuthEncodedParameters &encodedParameters = KQOAuthEncodedParameters(),
+                             const KQOAuthParameterList &sortedParameters = KQOAuthParameterList(),
+                             const KQOAuthParameterList &parameters = KQOAuthParameterList());
+    // The same for parameters in any order, returned as a QByteArray.
+    static QByteArray build(const QString &httpMethod, const QString &endpoint,
+                            const KQOAuthParameterList &parameters);
+
+    // Returns "METHOD&" + encoded endpoint + "&", the part of the base string that does not
+    // depend on the parameters.
+    static QByteArray prefix(const QString &httpMethod, const QString &endpoint);
+};
+
+#endif // KQOAUTHBASESTRING_P_H
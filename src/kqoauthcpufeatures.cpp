@@ -0,0 +1,101 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "kqoauthcpufeatures_p.h"
+
+#ifdef KQOAUTH_X86_DISPATCH
+#  include <cpuid.h>
+
+static bool cpuHasSse2() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return edx & (1u << 26);
+}
+
+static bool cpuHasAvx2() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+
+    // The OS must save the YMM registers (OSXSAVE and AVX, then XCR0 bits 1 and 2).
+    if (!(ecx & (1u << 27)) || !(ecx & (1u << 28))) {
+        return false;
+    }
+    unsigned int xcr0Low, xcr0High;
+    __asm__ ("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+    if ((xcr0Low & 6) != 6) {
+        return false;
+    }
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return ebx & (1u << 5);
+}
+
+static bool cpuHasShaNi() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+
+    // SSSE3 and SSE4.1 are used next to the SHA instructions.
+    if (!(ecx & (1u << 9)) || !(ecx & (1u << 19))) {
+        return false;
+    }
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return ebx & (1u << 29);
+}
+
+bool KQOAuthCpuFeatures::hasSse2() {
+    static const bool supported = cpuHasSse2();
+    return supported;
+}
+
+bool KQOAuthCpuFeatures::hasAvx2() {
+    static const bool supported = cpuHasAvx2();
+    return supported;
+}
+
+bool KQOAuthCpuFeatures::hasShaNi() {
+    static const bool supported = cpuHasShaNi();
+    return supported;
+}
+
+#else
+
+bool KQOAuthCpuFeatures::hasSse2() {
+    return false;
+}
+
+bool KQOAuthCpuFeatures::hasAvx2() {
+    return false;
+}
+
+bool KQOAuthCpuFeatures::hasShaNi() {
+    return false;
+}
+
+#endif // KQOAUTH_X86_DISPATCH
@@ -0,0 +1,45 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHCPUFEATURES_P_H
+#define KQOAUTHCPUFEATURES_P_H
+
+#include <QString>
+
+#include "kqoauthglobals.h"
+
+// x86 kernels are compiled with per function target attributes and picked at runtime.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#  define KQOAUTH_X86_DISPATCH
+#endif
+
+/**
+ * The instruction set extensions the SIMD code paths need. Detected once, the first
+ * time they are asked for. All of them are false when KQOAUTH_X86_DISPATCH is not defined.
+ */
+class KQOAUTH_EXPORT KQOAuthCpuFeatures
+{
+public:
+    static bool hasSse2();
+    static bool hasAvx2();
+    static bool hasShaNi();
+};
+
+#endif // KQOAUTHCPUFEATURES_P_H
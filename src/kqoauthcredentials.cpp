@@ -0,0 +1,126 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtGlobal>
+
+#include "kqoauthcredentials.h"
+#include "kqoauthcredentials_p.h"
+#include "kqoauthsigner_p.h"
+#include "kqoauthsigningcontext_p.h"
+#include "kqoauthpercentencoder_p.h"
+
+KQOAuthCredentialsPrivate::KQOAuthCredentialsPrivate() :
+    signatureMethod(KQOAuthRequest::HMAC_SHA1)
+{
+}
+
+// key="percent encoded value"
+static QByteArray headerFragment(const QLatin1String &key, const QString &value) {
+    QByteArray fragment(key.latin1());
+    fragment.append("=\"");
+    KQOAuthPercentEncoder::append(fragment, value);
+    fragment.append('"');
+    return fragment;
+}
+
+// Empty credentials share one private.
+struct KQOAuthEmptyCredentials
+{
+    KQOAuthEmptyCredentials() : d(new KQOAuthCredentialsPrivate) {}
+    QSharedDataPointer<KQOAuthCredentialsPrivate> d;
+};
+Q_GLOBAL_STATIC(KQOAuthEmptyCredentials, emptyCredentials)
+
+KQOAuthCredentials::KQOAuthCredentials() :
+    d(emptyCredentials()->d)
+{
+}
+
+KQOAuthCredentials::KQOAuthCredentials(const QString &consumerKey,
+                                       const QString &consumerSecretKey,
+                                       const QString &token,
+                                       const QString &tokenSecret,
+                                       KQOAuthRequest::RequestSignatureMethod signatureMethod) :
+    d(new KQOAuthCredentialsPrivate)
+{
+    d->consumerKey = consumerKey;
+    d->consumerSecretKey = consumerSecretKey;
+    d->token = token;
+    d->tokenSecret = tokenSecret;
+    d->signatureMethod = signatureMethod;
+    d->version = "1.0";
+
+    d->signatureMethodString = KQOAuthSigner::methodName(signatureMethod);
+    if (d->signatureMethodString.isEmpty()) {
+        qWarning("Invalid signature method set.");
+    } else if (signatureMethod == KQOAuthRequest::HMAC_SHA1) {
+        d->signingContext = QSharedPointer<const KQOAuthSigningContext>(
+                    new KQOAuthSigningContext(consumerSecretKey, tokenSecret));
+    }
+
+    d->consumerKeyHeader = headerFragment(OAUTH_KEY_CONSUMER_KEY, consumerKey);
+    d->signatureMethodHeader = headerFragment(OAUTH_KEY_SIGNATURE_METHOD, d->signatureMethodString);
+    d->tokenHeader = headerFragment(OAUTH_KEY_TOKEN, token);
+    d->versionHeader = headerFragment(OAUTH_KEY_VERSION, d->version);
+
+    KQOAuthParameterList parameters;
+    parameters.append(qMakePair(QString(OAUTH_KEY_CONSUMER_KEY), consumerKey));
+    parameters.append(qMakePair(QString(OAUTH_KEY_SIGNATURE_METHOD), d->signatureMethodString));
+    parameters.append(qMakePair(QString(OAUTH_KEY_TOKEN), token));
+    parameters.append(qMakePair(QString(OAUTH_KEY_VERSION), d->version));
+    d->encodedParameters = KQOAuthEncodedParameters(parameters);
+}
+
+KQOAuthCredentials::KQOAuthCredentials(const KQOAuthCredentials &other) :
+    d(other.d)
+{
+}
+
+KQOAuthCredentials &KQOAuthCredentials::operator=(const KQOAuthCredentials &other) {
+    d = other.d;
+    return *this;
+}
+
+KQOAuthCredentials::~KQOAuthCredentials()
+{
+}
+
+bool KQOAuthCredentials::isEmpty() const {
+    return d->signatureMethodString.isEmpty();
+}
+
+QString KQOAuthCredentials::consumerKey() const {
+    return d->consumerKey;
+}
+
+QString KQOAuthCredentials::consumerSecretKey() const {
+    return d->consumerSecretKey;
+}
+
+QString KQOAuthCredentials::token() const {
+    return d->token;
+}
+
+QString KQOAuthCredentials::tokenSecret() const {
+    return d->tokenSecret;
+}
+
+KQOAuthRequest::RequestSignatureMethod KQOAuthCredentials::signatureMethod() const {
+    return d->signatureMethod;
+}
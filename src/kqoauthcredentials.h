@@ -0,0 +1,65 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KQOAUTHCREDENTIALS_H
+#define KQOAUTHCREDENTIALS_H
+
+#include <QString>
+#include <QSharedDataPointer>
+
+#include "kqoauthglobals.h"
+#include "kqoauthrequest.h"
+
+class KQOAuthCredentialsPrivate;
+
+/**
+ * The consumer key and secret, the token and token secret and the signature method, bound
+ * together once and shared by every request signed with them. Their percent encoded forms and
+ * the HMAC-SHA1 key state are prepared when the credentials are created, so a request given
+ * them with KQOAuthRequest::setCredentials() copies no strings and encodes none of them again.
+ * Copies are cheap and share the same data.
+ */
+class KQOAUTH_EXPORT KQOAuthCredentials
+{
+public:
+    KQOAuthCredentials();
+    KQOAuthCredentials(const QString &consumerKey,
+                       const QString &consumerSecretKey,
+                       const QString &token = QString(),
+                       const QString &tokenSecret = QString(),
+                       KQOAuthRequest::RequestSignatureMethod signatureMethod = KQOAuthRequest::HMAC_SHA1);
+    KQOAuthCredentials(const KQOAuthCredentials &other);
+    KQOAuthCredentials &operator=(const KQOAuthCredentials &other);
+    ~KQOAuthCredentials();
+
+    bool isEmpty() const;
+
+    QString consumerKey() const;
+    QString consumerSecretKey() const;
+    QString token() const;
+    QString tokenSecret() const;
+    KQOAuthRequest::RequestSignatureMethod signatureMethod() const;
+
+private:
+    QSharedDataPointer<KQOAuthCredentialsPrivate> d;
+
+    friend class KQOAuthRequestPrivate;
+};
+
+#endif // KQOAUTHCREDENTIALS_H
@@ -0,0 +1,61 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHCREDENTIALS_P_H
+#define KQOAUTHCREDENTIALS_P_H
+
+#include <QSharedData>
+#include <QSharedPointer>
+#include <QString>
+#include <QByteArray>
+
+#include "kqoauthrequest.h"
+#include "kqoauthbasestring_p.h"
+
+class KQOAuthSigningContext;
+
+class KQOAuthCredentialsPrivate : public QSharedData
+{
+public:
+    KQOAuthCredentialsPrivate();
+
+    QString consumerKey;
+    QString consumerSecretKey;
+    QString token;
+    QString tokenSecret;
+    KQOAuthRequest::RequestSignatureMethod signatureMethod;
+    QString signatureMethodString;
+    QString version;
+
+    // The HMAC-SHA1 key state, null for other signature methods.
+    QSharedPointer<const KQOAuthSigningContext> signingContext;
+
+    // Authorization header fragments, key="encoded value", of the parameters above.
+    QByteArray consumerKeyHeader;
+    QByteArray signatureMethodHeader;
+    QByteArray tokenHeader;
+    QByteArray versionHeader;
+
+    // oauth_consumer_key, oauth_signature_method, oauth_token and oauth_version, encoded for
+    // the base string of an authorized request.
+    KQOAuthEncodedParameters encodedParameters;
+};
+
+#endif // KQOAUTHCREDENTIALS_P_H
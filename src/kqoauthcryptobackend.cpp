@@ -0,0 +1,509 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// The HMAC keys resume from a copied SHA_CTX, which only the SHA1_* functions deprecated in
+// OpenSSL 3.0 allow.
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <string.h>
+
+#include <QCryptographicHash>
+#include <QThreadStorage>
+
+#include "kqoauthcryptobackend_p.h"
+#include "kqoauthsha1_p.h"
+
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#else
+#include <openssl/hmac.h>
+#endif
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+static HMAC_CTX *HMAC_CTX_new() {
+    HMAC_CTX *ctx = new HMAC_CTX;
+    HMAC_CTX_init(ctx);
+    return ctx;
+}
+
+static void HMAC_CTX_free(HMAC_CTX *ctx) {
+    HMAC_CTX_cleanup(ctx);
+    delete ctx;
+}
+#endif
+
+Q_GLOBAL_STATIC(KQOAuthQtCryptoBackend, qtCryptoBackend)
+Q_GLOBAL_STATIC(KQOAuthBuiltinCryptoBackend, builtinCryptoBackend)
+Q_GLOBAL_STATIC(KQOAuthOpenSslCryptoBackend, openSslCryptoBackend)
+
+KQOAuthCryptoBackend *KQOAuthCryptoBackend::instance(KQOAuthUtils::CryptoBackend backend) {
+    switch (backend) {
+    case KQOAuthUtils::QtCryptoBackend:
+        return qtCryptoBackend();
+    case KQOAuthUtils::BuiltinCryptoBackend:
+        return builtinCryptoBackend();
+    case KQOAuthUtils::OpenSslCryptoBackend:
+    default:
+        return openSslCryptoBackend();
+    }
+}
+
+//////////// Qt backend ////////////
+
+class KQOAuthQtSha1Digest : public KQOAuthSha1Digest
+{
+public:
+    KQOAuthQtSha1Digest() :
+        hash(QCryptographicHash::Sha1)
+    {
+    }
+
+    void addData(const char *data, int length) {
+        hash.addData(data, length);
+    }
+
+    bool result(uchar *digest) {
+        memcpy(digest, hash.result().constData(), KQOAuthCryptoBackend::DigestSize);
+        return true;
+    }
+
+private:
+    QCryptographicHash hash;
+};
+
+// QCryptographicHash cannot resume from a chaining state, so the pads are kept and hashed
+// again for every message.
+class KQOAuthQtHmacSha1Key : public KQOAuthHmacSha1Key
+{
+public:
+    KQOAuthQtHmacSha1Key(const char *key, int length) {
+        QByteArray keyBytes(key, length);
+        const int blockSize = 64;   // Both MD5 and SHA-1 have a block size of 64.
+
+        // If key is longer than block size, we need to hash the key
+        if (keyBytes.size() > blockSize) {
+            keyBytes = QCryptographicHash::hash(keyBytes, QCryptographicHash::Sha1);
+        }
+
+        /* http://tools.ietf.org/html/rfc2104  - (1) */
+        // Create the opad and ipad for the hash function.
+        ipad.fill(0, blockSize);
+        opad.fill(0, blockSize);
+
+        ipad.replace(0, keyBytes.length(), keyBytes);
+        opad.replace(0, keyBytes.length(), keyBytes);
+
+        /* http://tools.ietf.org/html/rfc2104 - (2) & (5) */
+        for (int i = 0; i < blockSize; i++) {
+            ipad[i] = ipad[i] ^ 0x36;
+            opad[i] = opad[i] ^ 0x5c;
+        }
+    }
+
+    bool sign(const char *message, int length, uchar *digest) const {
+        /* http://tools.ietf.org/html/rfc2104 - (3) & (4) */
+        QCryptographicHash inner(QCryptographicHash::Sha1);
+        inner.addData(ipad);
+        inner.addData(message, length);
+
+        /* http://tools.ietf.org/html/rfc2104 - (6) & (7) */
+        QCryptographicHash outer(QCryptographicHash::Sha1);
+        outer.addData(opad);
+        outer.addData(inner.result());
+        memcpy(digest, outer.result().constData(), KQOAuthCryptoBackend::DigestSize);
+        return true;
+    }
+
+private:
+    QByteArray ipad;
+    QByteArray opad;
+};
+
+const char *KQOAuthQtCryptoBackend::name() const {
+    return "qt";
+}
+
+KQOAuthSha1Digest *KQOAuthQtCryptoBackend::createSha1() {
+    return new KQOAuthQtSha1Digest;
+}
+
+KQOAuthHmacSha1Key *KQOAuthQtCryptoBackend::createHmacSha1Key(const char *key, int length) {
+    return new KQOAuthQtHmacSha1Key(key, length);
+}
+
+bool KQOAuthQtCryptoBackend::hmacSha1(const char *message, int length, const char *key, int keyLength,
+                                      uchar *digest) {
+    return KQOAuthQtHmacSha1Key(key, keyLength).sign(message, length, digest);
+}
+
+bool KQOAuthQtCryptoBackend::hmacSha1Batch(const char * const *messages, const int *messageLengths,
+                                           const char * const *keys, const int *keyLengths,
+                                           int count, uchar *digests) {
+    for (int i = 0; i < count; i++) {
+        if (!hmacSha1(messages[i], messageLengths[i], keys[i], keyLengths[i], digests + i * DigestSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//////////// Builtin backend ////////////
+
+class KQOAuthBuiltinSha1Digest : public KQOAuthSha1Digest
+{
+public:
+    void addData(const char *data, int length) {
+        sha1.addData(data, length);
+    }
+
+    bool result(uchar *digest) {
+        sha1.result(digest);
+        return true;
+    }
+
+private:
+    KQOAuthSha1 sha1;
+};
+
+class KQOAuthBuiltinHmacSha1Key : public KQOAuthHmacSha1Key
+{
+public:
+    KQOAuthBuiltinHmacSha1Key(const char *key, int length) {
+        /* http://tools.ietf.org/html/rfc2104  - (1) */
+        uchar keyBlock[KQOAuthSha1::BlockSize];
+        memset(keyBlock, 0, KQOAuthSha1::BlockSize);
+        if (length > KQOAuthSha1::BlockSize) {
+            // If key is longer than block size, we need to hash the key
+            KQOAuthSha1 keyHash;
+            keyHash.addData(key, length);
+            keyHash.result(keyBlock);
+        } else {
+            memcpy(keyBlock, key, length);
+        }
+
+        /* http://tools.ietf.org/html/rfc2104 - (2) & (5) */
+        uchar ipad[KQOAuthSha1::BlockSize];
+        uchar opad[KQOAuthSha1::BlockSize];
+        for (int i = 0; i < KQOAuthSha1::BlockSize; i++) {
+            ipad[i] = keyBlock[i] ^ 0x36;
+            opad[i] = keyBlock[i] ^ 0x5c;
+        }
+
+        // Store the chaining state after the pads, this is all we need from the key.
+        innerState = KQOAuthSha1::initialState();
+        KQOAuthSha1::compress(innerState, ipad, 1);
+        outerState = KQOAuthSha1::initialState();
+        KQOAuthSha1::compress(outerState, opad, 1);
+    }
+
+    bool sign(const char *message, int length, uchar *digest) const {
+        /* http://tools.ietf.org/html/rfc2104 - (3) & (4) */
+        KQOAuthSha1 inner(innerState, KQOAuthSha1::BlockSize);
+        inner.addData(message, length);
+        uchar innerDigest[KQOAuthSha1::DigestSize];
+        inner.result(innerDigest);
+
+        /* http://tools.ietf.org/html/rfc2104 - (6) & (7) */
+        KQOAuthSha1 outer(outerState, KQOAuthSha1::BlockSize);
+        outer.addData(reinterpret_cast<const char *>(innerDigest), KQOAuthSha1::DigestSize);
+        outer.result(digest);
+        return true;
+    }
+
+private:
+    KQOAuthSha1::State innerState;
+    KQOAuthSha1::State outerState;
+};
+
+const char *KQOAuthBuiltinCryptoBackend::name() const {
+    return "builtin";
+}
+
+KQOAuthSha1Digest *KQOAuthBuiltinCryptoBackend::createSha1() {
+    return new KQOAuthBuiltinSha1Digest;
+}
+
+KQOAuthHmacSha1Key *KQOAuthBuiltinCryptoBackend::createHmacSha1Key(const char *key, int length) {
+    return new KQOAuthBuiltinHmacSha1Key(key, length);
+}
+
+bool KQOAuthBuiltinCryptoBackend::hmacSha1(const char *message, int length, const char *key, int keyLength,
+                                           uchar *digest) {
+    return KQOAuthBuiltinHmacSha1Key(key, keyLength).sign(message, length, digest);
+}
+
+bool KQOAuthBuiltinCryptoBackend::hmacSha1Batch(const char * const *messages, const int *messageLengths,
+                                                const char * const *keys, const int *keyLengths,
+                                                int count, uchar *digests) {
+    KQOAuthSha1::hmacBatch(messages, messageLengths, keys, keyLengths, count, digests);
+    return true;
+}
+
+//////////// OpenSSL backend ////////////
+
+// The EVP contexts are not thread safe, so every thread gets its own set.
+// They are reused for every digest computed in that thread.
+class KQOAuthOpenSslThreadContexts
+{
+public:
+    KQOAuthOpenSslThreadContexts() {
+        digest = EVP_MD_CTX_create();
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        // Fetch the implementations once instead of on every EVP call.
+        sha1 = EVP_MD_fetch(0, "SHA1", 0);
+        mac = EVP_MAC_fetch(0, "HMAC", 0);
+        hmac = mac ? EVP_MAC_CTX_new(mac) : 0;
+        if (hmac) {
+            // The digest stays set on the context. Later EVP_MAC_init() calls only change the key.
+            char digestName[] = "SHA1";
+            OSSL_PARAM params[2];
+            params[0] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digestName, 0);
+            params[1] = OSSL_PARAM_construct_end();
+            EVP_MAC_CTX_set_params(hmac, params);
+        }
+#else
+        sha1 = EVP_sha1();
+        hmac = HMAC_CTX_new();
+#endif
+    }
+
+    ~KQOAuthOpenSslThreadContexts() {
+        EVP_MD_CTX_destroy(digest);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        EVP_MAC_CTX_free(hmac);
+        EVP_MAC_free(mac);
+        EVP_MD_free(sha1);
+#else
+        HMAC_CTX_free(hmac);
+#endif
+    }
+
+    EVP_MD_CTX *digest;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    EVP_MD *sha1;
+    EVP_MAC *mac;
+    EVP_MAC_CTX *hmac;
+#else
+    const EVP_MD *sha1;
+    HMAC_CTX *hmac;
+#endif
+};
+
+static QThreadStorage<KQOAuthOpenSslThreadContexts *> openSslContexts;
+
+static KQOAuthOpenSslThreadContexts *threadContexts() {
+    if (!openSslContexts.hasLocalData()) {
+        openSslContexts.setLocalData(new KQOAuthOpenSslThreadContexts);
+    }
+    return openSslContexts.localData();
+}
+
+class KQOAuthOpenSslSha1Digest : public KQOAuthSha1Digest
+{
+public:
+    KQOAuthOpenSslSha1Digest() :
+        context(EVP_MD_CTX_create())
+    {
+        ok = context != 0 && EVP_DigestInit_ex(context, EVP_sha1(), 0);
+    }
+
+    ~KQOAuthOpenSslSha1Digest() {
+        EVP_MD_CTX_destroy(context);
+    }
+
+    void addData(const char *data, int length) {
+        ok = ok && EVP_DigestUpdate(context, data, length);
+    }
+
+    bool result(uchar *digest) {
+        unsigned int digestLength = 0;
+        ok = ok && EVP_DigestFinal_ex(context, digest, &digestLength)
+                && digestLength == KQOAuthCryptoBackend::DigestSize;
+        if (!ok) {
+            qWarning("KQOAuthOpenSslCryptoBackend: SHA-1 digest failed.");
+        }
+        return ok;
+    }
+
+private:
+    EVP_MD_CTX *context;
+    bool ok;
+};
+
+#ifndef OPENSSL_NO_DEPRECATED_3_0
+// Keeps OpenSSL's SHA-1 state after each key pad, the way the builtin key does. Every message
+// resumes from copies on the stack, so signing runs OpenSSL's SHA-1 without allocating.
+// Copying a keyed EVP_MAC_CTX would allocate a dozen times per message.
+class KQOAuthOpenSslHmacSha1Key : public KQOAuthHmacSha1Key
+{
+public:
+    KQOAuthOpenSslHmacSha1Key(const char *key, int length) {
+        /* http://tools.ietf.org/html/rfc2104  - (1) */
+        unsigned char keyBlock[SHA_CBLOCK];
+        memset(keyBlock, 0, SHA_CBLOCK);
+        SHA_CTX context;
+        if (length > SHA_CBLOCK) {
+            // If key is longer than block size, we need to hash the key
+            keyed = SHA1_Init(&context) && SHA1_Update(&context, key, length) && SHA1_Final(keyBlock, &context);
+        } else {
+            memcpy(keyBlock, key, length);
+            keyed = true;
+        }
+
+        /* http://tools.ietf.org/html/rfc2104 - (2) & (5) */
+        unsigned char ipad[SHA_CBLOCK];
+        unsigned char opad[SHA_CBLOCK];
+        for (int i = 0; i < SHA_CBLOCK; i++) {
+            ipad[i] = keyBlock[i] ^ 0x36;
+            opad[i] = keyBlock[i] ^ 0x5c;
+        }
+
+        keyed = keyed && SHA1_Init(&innerState) && SHA1_Update(&innerState, ipad, SHA_CBLOCK)
+                && SHA1_Init(&outerState) && SHA1_Update(&outerState, opad, SHA_CBLOCK);
+        if (!keyed) {
+            qWarning("KQOAuthOpenSslCryptoBackend: Setting up the HMAC-SHA1 key failed.");
+        }
+    }
+
+    bool sign(const char *message, int length, uchar *digest) const {
+        /* http://tools.ietf.org/html/rfc2104 - (3) & (4) */
+        SHA_CTX context = innerState;
+        unsigned char innerDigest[SHA_DIGEST_LENGTH];
+        bool ok = keyed && SHA1_Update(&context, message, length) && SHA1_Final(innerDigest, &context);
+
+        /* http://tools.ietf.org/html/rfc2104 - (6) & (7) */
+        context = outerState;
+        ok = ok && SHA1_Update(&context, innerDigest, SHA_DIGEST_LENGTH) && SHA1_Final(digest, &context);
+        if (!ok) {
+            qWarning("KQOAuthOpenSslCryptoBackend: HMAC-SHA1 failed.");
+        }
+        return ok;
+    }
+
+private:
+    SHA_CTX innerState;
+    SHA_CTX outerState;
+    bool keyed;
+};
+#else
+// Without the SHA1_* functions, the key is an HMAC context keyed once and copied for every message.
+class KQOAuthOpenSslHmacSha1Key : public KQOAuthHmacSha1Key
+{
+public:
+    KQOAuthOpenSslHmacSha1Key(const char *key, int length) {
+        // A copy of this thread's context already has the digest set.
+        KQOAuthOpenSslThreadContexts *contexts = threadContexts();
+        keyed = contexts->hmac ? EVP_MAC_CTX_dup(contexts->hmac) : 0;
+        if (keyed && !EVP_MAC_init(keyed, reinterpret_cast<const unsigned char *>(key), length, 0)) {
+            EVP_MAC_CTX_free(keyed);
+            keyed = 0;
+        }
+        if (!keyed) {
+            qWarning("KQOAuthOpenSslCryptoBackend: Setting up the HMAC-SHA1 key failed.");
+        }
+    }
+
+    ~KQOAuthOpenSslHmacSha1Key() {
+        EVP_MAC_CTX_free(keyed);
+    }
+
+    // The keyed context is only read, each message is signed on its own copy.
+    bool sign(const char *message, int length, uchar *digest) const {
+        EVP_MAC_CTX *context = keyed ? EVP_MAC_CTX_dup(keyed) : 0;
+        size_t digestLength = 0;
+        const bool ok = context
+                && EVP_MAC_update(context, reinterpret_cast<const unsigned char *>(message), length)
+                && EVP_MAC_final(context, digest, &digestLength, KQOAuthCryptoBackend::DigestSize)
+                && digestLength == KQOAuthCryptoBackend::DigestSize;
+        EVP_MAC_CTX_free(context);
+        if (!ok) {
+            qWarning("KQOAuthOpenSslCryptoBackend: HMAC-SHA1 failed.");
+        }
+        return ok;
+    }
+
+private:
+    Q_DISABLE_COPY(KQOAuthOpenSslHmacSha1Key);
+
+    EVP_MAC_CTX *keyed;
+};
+#endif
+
+// A null 'key' signs with the key the context was last initialized with.
+static bool threadHmacSha1(KQOAuthOpenSslThreadContexts *contexts, const char *key, int keyLength,
+                           const char *message, int length, uchar *digest) {
+    const unsigned char *keyData = reinterpret_cast<const unsigned char *>(key);
+    const unsigned char *messageData = reinterpret_cast<const unsigned char *>(message);
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    size_t digestLength = 0;
+    return contexts->hmac
+            && EVP_MAC_init(contexts->hmac, keyData, keyLength, 0)
+            && EVP_MAC_update(contexts->hmac, messageData, length)
+            && EVP_MAC_final(contexts->hmac, digest, &digestLength, KQOAuthCryptoBackend::DigestSize)
+            && digestLength == KQOAuthCryptoBackend::DigestSize;
+#else
+    unsigned int digestLength = 0;
+    return contexts->hmac
+            && HMAC_Init_ex(contexts->hmac, keyData, keyLength, key ? contexts->sha1 : 0, 0)
+            && HMAC_Update(contexts->hmac, messageData, length)
+            && HMAC_Final(contexts->hmac, digest, &digestLength)
+            && digestLength == KQOAuthCryptoBackend::DigestSize;
+#endif
+}
+
+const char *KQOAuthOpenSslCryptoBackend::name() const {
+    return "openssl";
+}
+
+KQOAuthSha1Digest *KQOAuthOpenSslCryptoBackend::createSha1() {
+    return new KQOAuthOpenSslSha1Digest;
+}
+
+KQOAuthHmacSha1Key *KQOAuthOpenSslCryptoBackend::createHmacSha1Key(const char *key, int length) {
+    return new KQOAuthOpenSslHmacSha1Key(key, length);
+}
+
+bool KQOAuthOpenSslCryptoBackend::hmacSha1(const char *message, int length, const char *key, int keyLength,
+                                           uchar *digest) {
+    if (!threadHmacSha1(threadContexts(), key, keyLength, message, length, digest)) {
+        qWarning("KQOAuthOpenSslCryptoBackend: HMAC-SHA1 failed.");
+        return false;
+    }
+    return true;
+}
+
+bool KQOAuthOpenSslCryptoBackend::hmacSha1Batch(const char * const *messages, const int *messageLengths,
+                                                const char * const *keys, const int *keyLengths,
+                                                int count, uchar *digests) {
+    KQOAuthOpenSslThreadContexts *contexts = threadContexts();
+
+    for (int i = 0; i < count; i++) {
+        const bool sameKey = i > 0 && keys[i] == keys[i - 1] && keyLengths[i] == keyLengths[i - 1];
+        if (!threadHmacSha1(contexts, sameKey ? 0 : keys[i], keyLengths[i], messages[i], messageLengths[i],
+                            digests + i * DigestSize)) {
+            qWarning("KQOAuthOpenSslCryptoBackend: HMAC-SHA1 failed.");
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,129 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHCRYPTOBACKEND_P_H
+#define KQOAUTHCRYPTOBACKEND_P_H
+
+#include <QString>
+#include <QByteArray>
+
+#include "kqoauthglobals.h"
+#include "kqoauthutils.h"
+
+/**
+ * SHA-1 of data given in pieces, such as a request body read from a device.
+ */
+class KQOAUTH_EXPORT KQOAuthSha1Digest
+{
+public:
+    virtual ~KQOAuthSha1Digest() {}
+
+    virtual void addData(const char *data, int length) = 0;
+    // Writes the 20 byte digest. Returns false if the backend failed.
+    virtual bool result(uchar *digest) = 0;
+};
+
+/**
+ * HMAC-SHA1 with its key set up once, for signing any number of messages. Signing does not
+ * change it, so one key can sign from several threads at the same time.
+ */
+class KQOAUTH_EXPORT KQOAuthHmacSha1Key
+{
+public:
+    virtual ~KQOAuthHmacSha1Key() {}
+
+    // Writes the 20 byte digest of the message. Returns false if the backend failed.
+    virtual bool sign(const char *message, int length, uchar *digest) const = 0;
+};
+
+/**
+ * Interface for the digest primitives KQOAuthUtils and the request signing are built on.
+ * The backend in use is chosen at runtime with KQOAuthUtils::setCryptoBackend().
+ * Implementations must be safe to call from several threads at the same time.
+ */
+class KQOAUTH_EXPORT KQOAuthCryptoBackend
+{
+public:
+    enum {
+        DigestSize = 20
+    };
+
+    virtual ~KQOAuthCryptoBackend() {}
+
+    static KQOAuthCryptoBackend *instance(KQOAuthUtils::CryptoBackend backend);
+
+    virtual const char *name() const = 0;
+
+    // Owned by the caller.
+    virtual KQOAuthSha1Digest *createSha1() = 0;
+    virtual KQOAuthHmacSha1Key *createHmacSha1Key(const char *key, int length) = 0;
+
+    // The functions below write the raw 20 byte digests and return false if the backend failed.
+    virtual bool hmacSha1(const char *message, int length, const char *key, int keyLength,
+                          uchar *digest) = 0;
+    // HMAC-SHA1 of 'count' messages, DigestSize bytes per message to 'digests'.
+    // Consecutive messages with the same key pointer share the key setup.
+    virtual bool hmacSha1Batch(const char * const *messages, const int *messageLengths,
+                               const char * const *keys, const int *keyLengths,
+                               int count, uchar *digests) = 0;
+};
+
+// HMAC built by hand on top of QCryptographicHash. Needs nothing but QtCore.
+class KQOAUTH_EXPORT KQOAuthQtCryptoBackend : public KQOAuthCryptoBackend
+{
+public:
+    const char *name() const;
+    KQOAuthSha1Digest *createSha1();
+    KQOAuthHmacSha1Key *createHmacSha1Key(const char *key, int length);
+    bool hmacSha1(const char *message, int length, const char *key, int keyLength, uchar *digest);
+    bool hmacSha1Batch(const char * const *messages, const int *messageLengths,
+                       const char * const *keys, const int *keyLengths,
+                       int count, uchar *digests);
+};
+
+// KQOAuthSha1: SHA-NI or portable C, and 8 lane AVX2 for batches, picked from the CPU features.
+// A key hashes the HMAC key pads once and resumes from their chaining state for every message.
+class KQOAUTH_EXPORT KQOAuthBuiltinCryptoBackend : public KQOAuthCryptoBackend
+{
+public:
+    const char *name() const;
+    KQOAuthSha1Digest *createSha1();
+    KQOAuthHmacSha1Key *createHmacSha1Key(const char *key, int length);
+    bool hmacSha1(const char *message, int length, const char *key, int keyLength, uchar *digest);
+    bool hmacSha1Batch(const char * const *messages, const int *messageLengths,
+                       const char * const *keys, const int *keyLengths,
+                       int count, uchar *digests);
+};
+
+// OpenSSL EVP digest and HMAC. The EVP contexts are created once per thread and reused.
+// A key keeps OpenSSL's SHA-1 state after the HMAC key pads and signs from copies of it.
+class KQOAUTH_EXPORT KQOAuthOpenSslCryptoBackend : public KQOAuthCryptoBackend
+{
+public:
+    const char *name() const;
+    KQOAuthSha1Digest *createSha1();
+    KQOAuthHmacSha1Key *createHmacSha1Key(const char *key, int length);
+    bool hmacSha1(const char *message, int length, const char *key, int keyLength, uchar *digest);
+    bool hmacSha1Batch(const char * const *messages, const int *messageLengths,
+                       const char * const *keys, const int *keyLengths,
+                       int count, uchar *digests);
+};
+
+#endif // KQOAUTHCRYPTOBACKEND_P_H
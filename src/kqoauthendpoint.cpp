@@ -0,0 +1,121 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtGlobal>
+
+#include "kqoauthendpoint.h"
+#include "kqoauthendpoint_p.h"
+#include "kqoauthbasestring_p.h"
+
+static const char *httpMethodName(KQOAuthRequest::RequestHttpMethod httpMethod) {
+    switch (httpMethod) {
+    case KQOAuthRequest::GET:
+        return "GET";
+    case KQOAuthRequest::POST:
+        return "POST";
+    case KQOAuthRequest::HEAD:
+        return "HEAD";
+    case KQOAuthRequest::DELETE:
+        return "DELETE";
+    default:
+        return "";
+    }
+}
+
+KQOAuthEndpointPrivate::KQOAuthEndpointPrivate() :
+    valid(false)
+{
+}
+
+void KQOAuthEndpointPrivate::setUrl(const QUrl &requestUrl) {
+    url = requestUrl;
+    valid = url.isValid();
+
+    // http://oauth.net/core/1.0/#rfc.section.9.1.2
+    QUrl normalized(url);
+    const QString scheme = url.scheme().toLower();
+    normalized.setScheme(scheme);
+    normalized.setHost(url.host().toLower());
+    if ((scheme == "http" && url.port() == 80) || (scheme == "https" && url.port() == 443)) {
+        normalized.setPort(-1);
+    }
+    normalizedUrl = normalized.toString(QUrl::RemoveQuery | QUrl::RemoveFragment);
+
+    for (int method = KQOAuthRequest::GET; method <= KQOAuthRequest::DELETE; method++) {
+        baseStringPrefixes[method] =
+            KQOAuthBaseStringBuilder::prefix(httpMethodName(KQOAuthRequest::RequestHttpMethod(method)),
+                                             normalizedUrl);
+    }
+}
+
+// Empty handles share one private, so clearing a request does not allocate.
+struct KQOAuthEmptyEndpoint
+{
+    KQOAuthEmptyEndpoint() : d(new KQOAuthEndpointPrivate) {}
+    QSharedDataPointer<KQOAuthEndpointPrivate> d;
+};
+Q_GLOBAL_STATIC(KQOAuthEmptyEndpoint, emptyEndpoint)
+
+KQOAuthEndpoint::KQOAuthEndpoint() :
+    d(emptyEndpoint()->d)
+{
+}
+
+KQOAuthEndpoint::KQOAuthEndpoint(const QUrl &url) :
+    d(new KQOAuthEndpointPrivate)
+{
+    d->setUrl(url);
+}
+
+KQOAuthEndpoint::KQOAuthEndpoint(const KQOAuthEndpoint &other) :
+    d(other.d)
+{
+}
+
+KQOAuthEndpoint &KQOAuthEndpoint::operator=(const KQOAuthEndpoint &other) {
+    d = other.d;
+    return *this;
+}
+
+KQOAuthEndpoint::~KQOAuthEndpoint()
+{
+}
+
+bool KQOAuthEndpoint::isEmpty() const {
+    return d->url.isEmpty();
+}
+
+bool KQOAuthEndpoint::isValid() const {
+    return d->valid;
+}
+
+QUrl KQOAuthEndpoint::url() const {
+    return d->url;
+}
+
+QString KQOAuthEndpoint::normalizedUrl() const {
+    return d->normalizedUrl;
+}
+
+QByteArray KQOAuthEndpoint::baseStringPrefix(KQOAuthRequest::RequestHttpMethod httpMethod) const {
+    if (httpMethod < KQOAuthRequest::GET || httpMethod > KQOAuthRequest::DELETE) {
+        return KQOAuthBaseStringBuilder::prefix(QString(), d->normalizedUrl);
+    }
+    return d->baseStringPrefixes[httpMethod];
+}
@@ -0,0 +1,66 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KQOAUTHENDPOINT_H
+#define KQOAUTHENDPOINT_H
+
+#include <QUrl>
+#include <QByteArray>
+#include <QSharedDataPointer>
+
+#include "kqoauthglobals.h"
+#include "kqoauthrequest.h"
+
+class KQOAuthEndpointPrivate;
+
+/**
+ * A request endpoint that is parsed, validated and normalised once, when the handle is created.
+ * Copies are cheap and share the same data, so an application can keep one handle for each
+ * service URL it uses and give it to initRequest() or KQOAuthManager::sendAuthorizedRequest()
+ * every time, instead of a QUrl that has to be checked and encoded again for every request.
+ */
+class KQOAUTH_EXPORT KQOAuthEndpoint
+{
+public:
+    KQOAuthEndpoint();
+    explicit KQOAuthEndpoint(const QUrl &url);
+    KQOAuthEndpoint(const KQOAuthEndpoint &other);
+    KQOAuthEndpoint &operator=(const KQOAuthEndpoint &other);
+    ~KQOAuthEndpoint();
+
+    bool isEmpty() const;
+    bool isValid() const;
+
+    // The URL as given, query included. This is where the request is sent.
+    QUrl url() const;
+
+    // The URL used in the signature base string, http://oauth.net/core/1.0/#rfc.section.9.1.2
+    // The scheme and host are lower case, a default port is left out and the query
+    // and fragment are removed.
+    QString normalizedUrl() const;
+
+    // The start of the signature base string for 'httpMethod', "METHOD&" + the percent
+    // encoded normalized URL + "&". It is encoded when the handle is created.
+    QByteArray baseStringPrefix(KQOAuthRequest::RequestHttpMethod httpMethod) const;
+
+private:
+    QSharedDataPointer<KQOAuthEndpointPrivate> d;
+};
+
+#endif // KQOAUTHENDPOINT_H
@@ -0,0 +1,43 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHENDPOINT_P_H
+#define KQOAUTHENDPOINT_P_H
+
+#include <QSharedData>
+#include <QString>
+#include <QByteArray>
+#include <QUrl>
+
+class KQOAuthEndpointPrivate : public QSharedData
+{
+public:
+    KQOAuthEndpointPrivate();
+
+    void setUrl(const QUrl &url);
+
+    QUrl url;
+    bool valid;
+    QString normalizedUrl;
+    // One prefix for each KQOAuthRequest::RequestHttpMethod.
+    QByteArray baseStringPrefixes[4];
+};
+
+#endif // KQOAUTHENDPOINT_P_H
@@ -21,6 +21,7 @@
 #define KQOAUTHGLOBALS_H
 
 #include <QtCore/qglobal.h>
+#include <QtCore/qstring.h>
 
 #if defined(KQOAUTH)
 #  define KQOAUTH_EXPORT Q_DECL_EXPORT
@@ -29,16 +30,19 @@
 #endif
 
 //////////// Static constant definitions ///////////
-const QString OAUTH_KEY_CONSUMER("oauth_consumer");
-const QString OAUTH_KEY_CONSUMER_KEY("oauth_consumer_key");
-const QString OAUTH_KEY_TOKEN("oauth_token");
-const QString OAUTH_KEY_TOKEN_SECRET("oauth_token_secret");
-const QString OAUTH_KEY_SIGNATURE_METHOD("oauth_signature_method");
-const QString OAUTH_KEY_TIMESTAMP("oauth_timestamp");
-const QString OAUTH_KEY_NONCE("oauth_nonce");
-const QString OAUTH_KEY_SIGNATURE("oauth_signature");
-const QString OAUTH_KEY_CALLBACK("oauth_callback");
-const QString OAUTH_KEY_VERIFIER("oauth_verifier");
-const QString OAUTH_KEY_VERSION("oauth_version");
+// QLatin1String only wraps the literal, so these need no construction at startup and
+// still convert to QString where one is needed.
+const QLatin1String OAUTH_KEY_CONSUMER("oauth_consumer");
+const QLatin1String OAUTH_KEY_CONSUMER_KEY("oauth_consumer_key");
+const QLatin1String OAUTH_KEY_TOKEN("oauth_token");
+const QLatin1String OAUTH_KEY_TOKEN_SECRET("oauth_token_secret");
+const QLatin1String OAUTH_KEY_SIGNATURE_METHOD("oauth_signature_method");
+const QLatin1String OAUTH_KEY_TIMESTAMP("oauth_timestamp");
+const QLatin1String OAUTH_KEY_NONCE("oauth_nonce");
+const QLatin1String OAUTH_KEY_SIGNATURE("oauth_signature");
+const QLatin1String OAUTH_KEY_CALLBACK("oauth_callback");
+const QLatin1String OAUTH_KEY_VERIFIER("oauth_verifier");
+const QLatin1String OAUTH_KEY_VERSION("oauth_version");
+const QLatin1String OAUTH_KEY_BODY_HASH("oauth_body_hash");
 
 #endif // KQOAUTHGLOBALS_H
@@ -0,0 +1,70 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "kqoauthinterntable_p.h"
+#include "kqoauthpercentencoder_p.h"
+
+KQOAuthInternTable::KQOAuthInternTable(int maxEntries) :
+    entries(maxEntries),
+    hitCount(0),
+    missCount(0)
+{
+}
+
+// QCache moves an entry it returns to the front, and drops the ones at the back when full.
+QByteArray KQOAuthInternTable::encoded(const QString &text) {
+    const QByteArray *interned = entries.object(text);
+    if (interned != 0) {
+        hitCount++;
+        return *interned;
+    }
+
+    missCount++;
+    QByteArray *encodedText = new QByteArray;
+    KQOAuthPercentEncoder::append(*encodedText, text);
+    const QByteArray result = *encodedText;
+    entries.insert(text, encodedText);
+    return result;
+}
+
+void KQOAuthInternTable::setMaxEntries(int maxEntries) {
+    entries.setMaxCost(maxEntries);
+}
+
+int KQOAuthInternTable::maxEntries() const {
+    return entries.maxCost();
+}
+
+int KQOAuthInternTable::count() const {
+    return entries.count();
+}
+
+int KQOAuthInternTable::hits() const {
+    return hitCount;
+}
+
+int KQOAuthInternTable::misses() const {
+    return missCount;
+}
+
+void KQOAuthInternTable::clear() {
+    entries.clear();
+    hitCount = 0;
+    missCount = 0;
+}
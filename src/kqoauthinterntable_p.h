@@ -0,0 +1,62 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHINTERNTABLE_P_H
+#define KQOAUTHINTERNTABLE_P_H
+
+#include <QString>
+#include <QByteArray>
+#include <QCache>
+
+#include "kqoauthglobals.h"
+
+/**
+ * Percent encoded UTF-8 of recurring parameter keys and values, such as "count" or
+ * "include_entities". KQOAuthManager owns one when setParameterInternTableSize() enables it
+ * and shares it with the requests it executes, which copy the encoded bytes instead of
+ * converting and encoding the same strings for every request.
+ * At most maxEntries() strings are kept and the least recently used one makes room for a new
+ * one. Strings longer than MaxLength are not worth keeping and are not looked up.
+ * The table is used on the thread of the manager only.
+ */
+class KQOAUTH_EXPORT KQOAuthInternTable
+{
+public:
+    enum { MaxLength = 128 };
+
+    explicit KQOAuthInternTable(int maxEntries);
+
+    // Returns the encoded form of 'text', from the table or encoded now and added to it.
+    QByteArray encoded(const QString &text);
+
+    void setMaxEntries(int maxEntries);
+    int maxEntries() const;
+    int count() const;
+    int hits() const;
+    int misses() const;
+    void clear();
+
+private:
+    QCache<QString, QByteArray> entries;
+    int hitCount;
+    int missCount;
+};
+
+#endif // KQOAUTHINTERNTABLE_P_H
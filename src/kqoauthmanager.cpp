@@ -25,6 +25,8 @@
 
 #include "kqoauthmanager.h"
 #include "kqoauthmanager_p.h"
+#include "kqoauthendpoint.h"
+#include "kqoauthrequestdata.h"
 
 
 ////////////// Private d_ptr implementation ////////////////
@@ -40,12 +42,21 @@ KQOAuthManagerPrivate::KQOAuthManagerPrivate(KQOAuthManager *parent) :
     autoAuth(false),
     handleAuthPageOpening(true),
     networkManager(new QNetworkAccessManager),
-    managerUserSet(false)
+    managerUserSet(false),
+    requestPoolSize(8),
+    requestPoolHits(0),
+    requestPoolMisses(0),
+    rsaSigningQueue(0),
+    rsaSigningThreads(0),
+    maxPendingRsaSignatures(KQOAuthRsaSigningQueue::DefaultMaxPendingCount)
 {
 
 }
 
 KQOAuthManagerPrivate::~KQOAuthManagerPrivate() {
+    delete rsaSigningQueue;
+    rsaSigningQueue = 0;
+
     delete opaqueRequest;
     opaqueRequest = 0;
 
@@ -55,18 +66,15 @@ KQOAuthManagerPrivate::~KQOAuthManagerPrivate() {
     }
 }
 
-QList< QPair<QString, QString> > KQOAuthManagerPrivate::createQueryParams(const KQOAuthParameters &requestParams) {
-    QList<QString> requestKeys = requestParams.keys();
-    QList<QString> requestValues = requestParams.values();
-
-    QList< QPair<QString, QString> > result;
-    for(int i=0; i<requestKeys.size(); i++) {
-        result.append( qMakePair(requestKeys.at(i),
-                                 requestValues.at(i))
-                      );
-    }
-
-    return result;
+// The query is replaced by the request's form parameters, which are percent encoded already.
+QUrl KQOAuthManagerPrivate::urlWithQueryParams(const QUrl &url, const QByteArray &query) {
+    QUrl urlWithParams = url;
+#if QT_VERSION < 0x050000
+    urlWithParams.setEncodedQuery(query);
+#else
+    urlWithParams.setQuery(QString::fromLatin1(query));
+#endif
+    return urlWithParams;
 }
 
 QMultiMap<QString, QString> KQOAuthManagerPrivate::createTokensFromResponse(QByteArray reply) {
@@ -137,6 +145,203 @@ bool KQOAuthManagerPrivate::setupCallbackServer() {
 }
 
 
+bool KQOAuthManagerPrivate::signAsynchronously(KQOAuthRequest *request, int id, bool authorized) {
+    Q_Q(KQOAuthManager);
+
+    if (rsaSigningThreads <= 0 || request->requestSignatureMethodForManager() != KQOAuthRequest::RSA_SHA1) {
+        return false;
+    }
+
+    if (rsaSigningQueue == 0) {
+        rsaSigningQueue = new KQOAuthRsaSigningQueue;
+        QObject::connect(rsaSigningQueue, SIGNAL(signatureReady(int, QByteArray)),
+                         q, SLOT(onRsaSignatureReady(int, QByteArray)));
+    }
+    rsaSigningQueue->setMaxThreadCount(rsaSigningThreads);
+    rsaSigningQueue->setMaxPendingCount(maxPendingRsaSignatures);
+
+    // The base string is fixed here, on this thread. Only the RSA operation runs in the pool.
+    PendingRsaRequest pendingRequest;
+    pendingRequest.request = request;
+    pendingRequest.queuedRequest = request;
+    pendingRequest.baseString = request->signatureBaseStringForManager();
+    pendingRequest.id = id;
+    pendingRequest.authorized = authorized;
+
+    // A full queue does not drop the request. It is signed on this thread instead, which
+    // also holds the caller back until the pool catches up.
+    int ticket = rsaSigningQueue->enqueue(request->consumerKeySecretForManager(), pendingRequest.baseString);
+    if (ticket < 0) {
+        return false;
+    }
+    pendingRsaRequests.insert(ticket, pendingRequest);
+    requestsBeingSigned.insert(request);
+    return true;
+}
+
+KQOAuthRequest *KQOAuthManagerPrivate::createOwnedRequest(const KQOAuthRequestData &requestData) {
+    KQOAuthRequest *request = takePooledRequest();
+    request->setRequestDataForManager(requestData);
+    ownedRequests.insert(request);
+    return request;
+}
+
+KQOAuthRequest *KQOAuthManagerPrivate::takePooledRequest() {
+    Q_Q(KQOAuthManager);
+
+    if (requestPool.isEmpty()) {
+        requestPoolMisses++;
+        return new KQOAuthRequest(q);
+    }
+
+    requestPoolHits++;
+    KQOAuthRequest *request = requestPool.takeLast();
+    request->resetForManager();
+    return request;
+}
+
+void KQOAuthManagerPrivate::releaseOwnedRequest(KQOAuthRequest *request) {
+    if (ownedRequests.remove(request)) {
+        // Slots handling the reply may still use it, so it is only reset when it is reused.
+        if (requestPool.size() < requestPoolSize) {
+            requestPool.append(request);
+        } else {
+            request->deleteLater();
+        }
+    }
+}
+
+void KQOAuthManagerPrivate::releaseOwnedRequestIfNotSent(KQOAuthRequest *request) {
+    if (requestMap.contains(request) || requestsBeingSigned.contains(request)) {
+        return;
+    }
+
+    releaseOwnedRequest(request);
+}
+
+void KQOAuthManagerPrivate::submitRequest(KQOAuthRequest *request) {
+    Q_Q(KQOAuthManager);
+
+    QNetworkRequest networkRequest;
+    networkRequest.setUrl( request->requestEndpoint() );
+
+    // Share the precomputed HMAC key state between all requests using the same credentials.
+    // Requests given KQOAuthCredentials bring their own.
+    if (request->requestSignatureMethodForManager() != KQOAuthRequest::RSA_SHA1
+            && !request->hasSigningContextForManager()) {
+        request->setSigningContextForManager(signingContexts.context(request->consumerKeySecretForManager(),
+                                                                     request->tokenSecretForManager()));
+    }
+
+    // And now fill the request with "Authorization" header data.
+    networkRequest.setRawHeader("Authorization", request->authorizationHeader());
+
+    QObject::connect(networkManager, SIGNAL(finished(QNetworkReply *)),
+                     q, SLOT(onRequestReplyReceived(QNetworkReply *)), Qt::UniqueConnection);
+    QObject::disconnect(networkManager, SIGNAL(finished(QNetworkReply *)),
+                        q, SLOT(onAuthorizedRequestReplyReceived(QNetworkReply *)));
+
+    if (request->httpMethod() == KQOAuthRequest::GET) {
+        // Take the original URL and append the query params to it.
+        networkRequest.setUrl(urlWithQueryParams(networkRequest.url(), request->queryForManager()));
+
+        // Submit the request including the params.
+        QNetworkReply *reply = networkManager->get(networkRequest);
+        QObject::connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
+                         q, SLOT(slotError(QNetworkReply::NetworkError)));
+        requestMap.insert( request, reply );
+
+    } else if (request->httpMethod() == KQOAuthRequest::POST) {
+
+        networkRequest.setHeader(QNetworkRequest::ContentTypeHeader, request->contentType());
+
+        QNetworkReply *reply;
+        if (request->contentType() == "application/x-www-form-urlencoded") {
+          reply = networkManager->post(networkRequest, request->requestBody());
+        } else {
+          if (request->rawDataDevice() != 0) {
+              reply = networkManager->post(networkRequest, request->rawDataDevice());
+          } else {
+              reply = networkManager->post(networkRequest, request->rawData());
+          }
+        }
+
+        QObject::connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
+                         q, SLOT(slotError(QNetworkReply::NetworkError)));
+        requestMap.insert( request, reply );
+    }
+
+    request->requestTimerStart();
+}
+
+void KQOAuthManagerPrivate::submitAuthorizedRequest(KQOAuthRequest *request, int id) {
+    Q_Q(KQOAuthManager);
+
+    QNetworkRequest networkRequest;
+    networkRequest.setUrl( request->requestEndpoint() );
+
+    // Share the precomputed HMAC key state between all requests using the same credentials.
+    // Requests given KQOAuthCredentials bring their own.
+    if (request->requestSignatureMethodForManager() != KQOAuthRequest::RSA_SHA1
+            && !request->hasSigningContextForManager()) {
+        request->setSigningContextForManager(signingContexts.context(request->consumerKeySecretForManager(),
+                                                                     request->tokenSecretForManager()));
+    }
+
+    // And now fill the request with "Authorization" header data.
+    networkRequest.setRawHeader("Authorization", request->authorizationHeader());
+
+
+    QObject::disconnect(networkManager, SIGNAL(finished(QNetworkReply *)),
+                        q, SLOT(onRequestReplyReceived(QNetworkReply *)));
+    QObject::connect(networkManager, SIGNAL(finished(QNetworkReply *)),
+                     q, SLOT(onAuthorizedRequestReplyReceived(QNetworkReply*)), Qt::UniqueConnection);
+
+    QNetworkReply *reply;
+
+
+    if (request->httpMethod() == KQOAuthRequest::POST) {
+
+        networkRequest.setHeader(QNetworkRequest::ContentTypeHeader, request->contentType());
+
+        if (request->contentType() == "application/x-www-form-urlencoded") {
+          reply = networkManager->post(networkRequest, request->requestBody());
+        } else {
+          if (request->rawDataDevice() != 0) {
+              reply = networkManager->post(networkRequest, request->rawDataDevice());
+          } else {
+              reply = networkManager->post(networkRequest, request->rawData());
+          }
+        }
+
+        QObject::connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
+                         q, SLOT(slotError(QNetworkReply::NetworkError)));
+        QObject::connect(request, SIGNAL(requestTimedout()),
+                         q, SLOT(requestTimeout()));
+        requestMap.insert( request, reply );
+    } else {
+        // Take the original URL and append the query params to it.
+        networkRequest.setUrl(urlWithQueryParams(networkRequest.url(), request->queryForManager()));
+
+        // Submit the request including the params.
+        if (request->httpMethod() == KQOAuthRequest::GET)
+            reply = networkManager->get(networkRequest);
+        else if (request->httpMethod() == KQOAuthRequest::HEAD)
+            reply = networkManager->head(networkRequest);
+        else if (request->httpMethod() == KQOAuthRequest::DELETE)
+            reply = networkManager->deleteResource(networkRequest);
+
+        QObject::connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
+                         q, SLOT(slotError(QNetworkReply::NetworkError)));
+        QObject::connect(request, SIGNAL(requestTimedout()),
+                         q, SLOT(requestTimeout()));
+        requestMap.insert( request, reply );
+    }
+    requestIds.insert(reply, id);
+    request->requestTimerStart();
+}
+
+
 /////////////// Public implementation ////////////////
 
 KQOAuthManager::KQOAuthManager(QObject *parent) :
@@ -165,7 +370,7 @@ void KQOAuthManager::executeRequest(KQOAuthRequest *request) {
         return;
     }
 
-    if (!request->requestEndpoint().isValid()) {
+    if (!request->endpoint().isValid()) {
         qWarning() << "Request endpoint URL is not valid. Cannot proceed.";
         d->error = KQOAuthManager::RequestEndpointError;
         return;
@@ -178,9 +383,7 @@ void KQOAuthManager::executeRequest(KQOAuthRequest *request) {
     }
 
     d->currentRequestType = request->requestType();
-
-    QNetworkRequest networkRequest;
-    networkRequest.setUrl( request->requestEndpoint() );
+    request->setInternTableForManager(d->internTable);
 
     if (d->autoAuth && d->currentRequestType == KQOAuthRequest::TemporaryCredentials) {
         d->setupCallbackServer();
@@ -192,70 +395,11 @@ void KQOAuthManager::executeRequest(KQOAuthRequest *request) {
         request->setCallbackUrl(QUrl(serverString));
     }
 
-    // And now fill the request with "Authorization" header data.
-    QList<QByteArray> requestHeaders = request->requestParameters();
-    QByteArray authHeader;
-
-    bool first = true;
-    foreach (const QByteArray header, requestHeaders) {
-        if (!first) {
-            authHeader.append(", ");
-        } else {
-            authHeader.append("OAuth ");
-            first = false;
-        }
-
-        authHeader.append(header);
-    }
-    networkRequest.setRawHeader("Authorization", authHeader);
-
-    connect(d->networkManager, SIGNAL(finished(QNetworkReply *)),
-            this, SLOT(onRequestReplyReceived(QNetworkReply *)), Qt::UniqueConnection);
-    disconnect(d->networkManager, SIGNAL(finished(QNetworkReply *)),
-            this, SLOT(onAuthorizedRequestReplyReceived(QNetworkReply *)));
-
-    if (request->httpMethod() == KQOAuthRequest::GET) {
-        // Get the requested additional params as a list of pairs we can give QUrl
-        QList< QPair<QString, QString> > urlParams = d->createQueryParams(request->additionalParameters());
-
-        // Take the original URL and append the query params to it.
-        QUrl urlWithParams = networkRequest.url();
-#if QT_VERSION < 0x050000
-        urlWithParams.setQueryItems(urlParams);
-#else
-        QUrlQuery query;
-        query.setQueryItems(urlParams);
-        urlWithParams.setQuery(query);
-#endif
-        networkRequest.setUrl(urlWithParams);
-
-        // Submit the request including the params.
-        QNetworkReply *reply = d->networkManager->get(networkRequest);
-        connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
-                 this, SLOT(slotError(QNetworkReply::NetworkError)));
-        d->requestMap.insert( request, reply );
-
-    } else if (request->httpMethod() == KQOAuthRequest::POST) {
-
-        networkRequest.setHeader(QNetworkRequest::ContentTypeHeader, request->contentType());
-
-        qDebug() << networkRequest.rawHeaderList();
-        qDebug() << networkRequest.rawHeader("Authorization");
-        qDebug() << networkRequest.rawHeader("Content-Type");
-
-        QNetworkReply *reply;
-        if (request->contentType() == "application/x-www-form-urlencoded") {
-          reply = d->networkManager->post(networkRequest, request->requestBody());
-        } else {
-          reply = d->networkManager->post(networkRequest, request->rawData());
-        }
-
-        connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
-                 this, SLOT(slotError(QNetworkReply::NetworkError)));
-        d->requestMap.insert( request, reply );
+    if (d->signAsynchronously(request, 0, false)) {
+        return;
     }
 
-    d->r->requestTimerStart();
+    d->submitRequest(request);
 }
 
 void KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
@@ -269,7 +413,7 @@ void KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
         return;
     }
 
-    if (!request->requestEndpoint().isValid()) {
+    if (!request->endpoint().isValid()) {
         qWarning() << "Request endpoint URL is not valid. Cannot proceed.";
         d->error = KQOAuthManager::RequestEndpointError;
         return;
@@ -283,97 +427,52 @@ void KQOAuthManager::executeAuthorizedRequest(KQOAuthRequest *request, int id) {
 
     d->currentRequestType = request->requestType();
 
-    QNetworkRequest networkRequest;
-    networkRequest.setUrl( request->requestEndpoint() );
-
     if ( d->currentRequestType != KQOAuthRequest::AuthorizedRequest){
         qWarning() << "Not Authorized Request. Cannot proceed";
         d->error = KQOAuthManager::RequestError;
         return;
     }
 
+    request->setInternTableForManager(d->internTable);
 
-    // And now fill the request with "Authorization" header data.
-    QList<QByteArray> requestHeaders = request->requestParameters();
-    QByteArray authHeader;
-
-    bool first = true;
-    foreach (const QByteArray header, requestHeaders) {
-        if (!first) {
-            authHeader.append(", ");
-        } else {
-            authHeader.append("OAuth ");
-            first = false;
-        }
-
-        authHeader.append(header);
+    if (d->signAsynchronously(request, id, true)) {
+        return;
     }
-    networkRequest.setRawHeader("Authorization", authHeader);
-
 
-    disconnect(d->networkManager, SIGNAL(finished(QNetworkReply *)),
-            this, SLOT(onRequestReplyReceived(QNetworkReply *)));
-    connect(d->networkManager, SIGNAL(finished(QNetworkReply *)),
-            this, SLOT(onAuthorizedRequestReplyReceived(QNetworkReply*)), Qt::UniqueConnection);
-
-    QNetworkReply *reply;
+    d->submitAuthorizedRequest(request, id);
+}
 
 
-    if (request->httpMethod() == KQOAuthRequest::POST) {
+void KQOAuthManager::executeRequest(const KQOAuthRequestData &requestData) {
+    Q_D(KQOAuthManager);
 
-        networkRequest.setHeader(QNetworkRequest::ContentTypeHeader, request->contentType());
+    KQOAuthRequest *request = d->createOwnedRequest(requestData);
+    executeRequest(request);
+    d->releaseOwnedRequestIfNotSent(request);
+}
 
-        /*
-        qDebug() << networkRequest.rawHeaderList();
-        qDebug() << networkRequest.rawHeader("Authorization");
-        qDebug() << networkRequest.rawHeader("Content-Type");
-        */
+void KQOAuthManager::executeAuthorizedRequest(const KQOAuthRequestData &requestData, int id) {
+    Q_D(KQOAuthManager);
 
-        if (request->contentType() == "application/x-www-form-urlencoded") {
-          reply = d->networkManager->post(networkRequest, request->requestBody());
-        } else {
-          reply = d->networkManager->post(networkRequest, request->rawData());
-        }
+    KQOAuthRequest *request = d->createOwnedRequest(requestData);
+    executeAuthorizedRequest(request, id);
+    d->releaseOwnedRequestIfNotSent(request);
+}
 
-        connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
-                 this, SLOT(slotError(QNetworkReply::NetworkError)));
-        connect(request, SIGNAL(requestTimedout()),
-                 this, SLOT(requestTimeout()));
-        d->requestMap.insert( request, reply );
-    } else {
-        // Get the requested additional params as a list of pairs we can give QUrl
-        QList< QPair<QString, QString> > urlParams = d->createQueryParams(request->additionalParameters());
+KQOAuthRequest *KQOAuthManager::acquireRequest() {
+    Q_D(KQOAuthManager);
 
-        // Take the original URL and append the query params to it.
-        QUrl urlWithParams = networkRequest.url();
-#if QT_VERSION < 0x050000
-        urlWithParams.setQueryItems(urlParams);
-#else
-        QUrlQuery query;
-        query.setQueryItems(urlParams);
-        urlWithParams.setQuery(query);
-#endif
-        networkRequest.setUrl(urlWithParams);
+    KQOAuthRequest *request = d->takePooledRequest();
+    d->ownedRequests.insert(request);
+    return request;
+}
 
-        // Submit the request including the params.
-        if (request->httpMethod() == KQOAuthRequest::GET)
-            reply = d->networkManager->get(networkRequest);
-        else if (request->httpMethod() == KQOAuthRequest::HEAD)
-            reply = d->networkManager->head(networkRequest);
-        else if (request->httpMethod() == KQOAuthRequest::DELETE)
-            reply = d->networkManager->deleteResource(networkRequest);
+void KQOAuthManager::releaseRequest(KQOAuthRequest *request) {
+    Q_D(KQOAuthManager);
 
-        connect(reply, SIGNAL(error(QNetworkReply::NetworkError)),
-                 this, SLOT(slotError(QNetworkReply::NetworkError)));
-        connect(request, SIGNAL(requestTimedout()),
-                 this, SLOT(requestTimeout()));
-        d->requestMap.insert( request, reply );
-    }
-    d->requestIds.insert(reply, id);
-    d->r->requestTimerStart();
+    d->releaseOwnedRequestIfNotSent(request);
 }
 
-
 void KQOAuthManager::setHandleUserAuthorization(bool set) {
     Q_D(KQOAuthManager);
 
@@ -426,6 +525,100 @@ void KQOAuthManager::setNetworkManager(QNetworkAccessManager *manager) {
     d->networkManager = manager;
 }
 
+void KQOAuthManager::setRsaSigningThreads(int maxThreads) {
+    Q_D(KQOAuthManager);
+
+    d->rsaSigningThreads = qMax(0, maxThreads);
+    if (d->rsaSigningQueue != 0 && d->rsaSigningThreads > 0) {
+        d->rsaSigningQueue->setMaxThreadCount(d->rsaSigningThreads);
+    }
+}
+
+int KQOAuthManager::rsaSigningThreads() const {
+    Q_D(const KQOAuthManager);
+
+    return d->rsaSigningThreads;
+}
+
+int KQOAuthManager::pendingRsaSignatures() const {
+    Q_D(const KQOAuthManager);
+
+    return d->pendingRsaRequests.size();
+}
+
+void KQOAuthManager::setMaxPendingRsaSignatures(int count) {
+    Q_D(KQOAuthManager);
+
+    d->maxPendingRsaSignatures = qMax(1, count);
+    if (d->rsaSigningQueue != 0) {
+        d->rsaSigningQueue->setMaxPendingCount(d->maxPendingRsaSignatures);
+    }
+}
+
+int KQOAuthManager::maxPendingRsaSignatures() const {
+    Q_D(const KQOAuthManager);
+
+    return d->maxPendingRsaSignatures;
+}
+
+void KQOAuthManager::setRequestPoolSize(int size) {
+    Q_D(KQOAuthManager);
+
+    d->requestPoolSize = qMax(0, size);
+    while (d->requestPool.size() > d->requestPoolSize) {
+        d->requestPool.takeLast()->deleteLater();
+    }
+}
+
+int KQOAuthManager::requestPoolSize() const {
+    Q_D(const KQOAuthManager);
+
+    return d->requestPoolSize;
+}
+
+int KQOAuthManager::requestPoolHits() const {
+    Q_D(const KQOAuthManager);
+
+    return d->requestPoolHits;
+}
+
+int KQOAuthManager::requestPoolMisses() const {
+    Q_D(const KQOAuthManager);
+
+    return d->requestPoolMisses;
+}
+
+void KQOAuthManager::setParameterInternTableSize(int size) {
+    Q_D(KQOAuthManager);
+
+    // Requests that are still using a dropped table keep their own reference to it.
+    if (size <= 0) {
+        d->internTable.clear();
+    } else if (d->internTable.isNull()) {
+        d->internTable = QSharedPointer<KQOAuthInternTable>(new KQOAuthInternTable(size));
+    } else {
+        d->internTable->setMaxEntries(size);
+    }
+}
+
+int KQOAuthManager::parameterInternTableSize() const {
+    Q_D(const KQOAuthManager);
+
+    return d->internTable.isNull() ? 0 : d->internTable->maxEntries();
+}
+
+int KQOAuthManager::parameterInternTableHits() const {
+    Q_D(const KQOAuthManager);
+
+    return d->internTable.isNull() ? 0 : d->internTable->hits();
+}
+
+int KQOAuthManager::parameterInternTableMisses() const {
+    Q_D(const KQOAuthManager);
+
+    return d->internTable.isNull() ? 0 : d->internTable->misses();
+}
+
 QNetworkAccessManager * KQOAuthManager::networkManager() const {
     Q_D(const KQOAuthManager);
 
@@ -514,6 +707,10 @@ void KQOAuthManager::verifyToken(const QString &token, const QString &verifier)
 }
 
 void KQOAuthManager::sendAuthorizedRequest(QUrl requestEndpoint, const KQOAuthParameters &requestParameters) {
+    sendAuthorizedRequest(KQOAuthEndpoint(requestEndpoint), requestParameters);
+}
+
+void KQOAuthManager::sendAuthorizedRequest(const KQOAuthEndpoint &requestEndpoint, const KQOAuthParameters &requestParameters) {
     Q_D(KQOAuthManager);
 
     if (!d->isAuthorized) {
@@ -573,6 +770,9 @@ void KQOAuthManager::onRequestReplyReceived( QNetworkReply *reply ) {
     QByteArray networkReply = reply->readAll();
 
     d->r = d->requestMap.key(reply);
+    // Owned requests go back to the pool only after the signals below, whose slots may
+    // reuse a pooled request, and after the last use of d->r.
+    KQOAuthRequest *finishedRequest = d->r;
     if( d->r ) {
         d->requestMap.remove(d->r);
         disconnect(d->r, SIGNAL(requestTimedout()),
@@ -585,6 +785,7 @@ void KQOAuthManager::onRequestReplyReceived( QNetworkReply *reply ) {
     // Just don't do anything if we didn't get anything useful.
     if(networkReply.isEmpty()) {
         reply->deleteLater();
+        d->releaseOwnedRequest(finishedRequest);
         return;
     }
     QMultiMap<QString, QString> responseTokens;
@@ -594,6 +795,7 @@ void KQOAuthManager::onRequestReplyReceived( QNetworkReply *reply ) {
         reply->deleteLater();
         emit requestReady(networkReply);
         d->emitTokens();
+        d->releaseOwnedRequest(finishedRequest);
         return;
     }
 
@@ -624,6 +826,7 @@ void KQOAuthManager::onRequestReplyReceived( QNetworkReply *reply ) {
     emit requestReady(networkReply);
 
     reply->deleteLater();           // We need to clean this up, after the event processing is done.
+    d->releaseOwnedRequest(finishedRequest);
 }
 
 void KQOAuthManager::onAuthorizedRequestReplyReceived( QNetworkReply *reply ) {
@@ -655,6 +858,8 @@ void KQOAuthManager::onAuthorizedRequestReplyReceived( QNetworkReply *reply ) {
 
     int id = d->requestIds.take(reply);
     d->r = d->requestMap.key(reply);
+    // Released at the end, as in onRequestReplyReceived().
+    KQOAuthRequest *finishedRequest = d->r;
     if( d->r ) {
         d->requestMap.remove(d->r);
         disconnect(d->r, SIGNAL(requestTimedout()),
@@ -670,12 +875,14 @@ void KQOAuthManager::onAuthorizedRequestReplyReceived( QNetworkReply *reply ) {
     // Just don't do anything if we didn't get anything useful.
     if(networkReply.isEmpty()) {
         reply->deleteLater();
+        d->releaseOwnedRequest(finishedRequest);
         return;
     }
 
     // We need to emit the signal even if we got an error.
     if (d->error != KQOAuthManager::NoError) {
         qWarning() << "Network reply error";
+        d->releaseOwnedRequest(finishedRequest);
         return;
     }
 
@@ -688,6 +895,7 @@ void KQOAuthManager::onAuthorizedRequestReplyReceived( QNetworkReply *reply ) {
 
     emit authorizedRequestReady(networkReply, id);
     reply->deleteLater();
+    d->releaseOwnedRequest(finishedRequest);
 }
 
 
@@ -711,6 +919,29 @@ void KQOAuthManager::onVerificationReceived(QMultiMap<QString, QString> response
     emit authorizationReceived(token, verifier);
 }
 
+void KQOAuthManager::onRsaSignatureReady(int ticket, QByteArray signature) {
+    Q_D(KQOAuthManager);
+
+    KQOAuthManagerPrivate::PendingRsaRequest pendingRequest = d->pendingRsaRequests.take(ticket);
+    d->requestsBeingSigned.remove(pendingRequest.queuedRequest);
+    if (pendingRequest.request.isNull()) {
+        // The request was deleted while it was being signed.
+        return;
+    }
+
+    KQOAuthRequest *request = pendingRequest.request;
+    d->r = request;
+    d->currentRequestType = request->requestType();
+
+    // If the signature is empty the request is signed again in submit, which reports the key error.
+    request->setRsaSignatureForManager(pendingRequest.baseString, signature);
+    if (pendingRequest.authorized) {
+        d->submitAuthorizedRequest(request, pendingRequest.id);
+    } else {
+        d->submitRequest(request);
+    }
+}
+
 void KQOAuthManager::slotError(QNetworkReply::NetworkError error) {
     Q_UNUSED(error)
     Q_D(KQOAuthManager);
@@ -27,6 +27,8 @@
 #include "kqoauthrequest.h"
 
 class KQOAuthRequest;
+class KQOAuthEndpoint;
+class KQOAuthRequestData;
 class KQOAuthManagerThread;
 class KQOAuthManagerPrivate;
 class QNetworkAccessManager;
@@ -60,6 +62,21 @@ public:
      */
     void executeRequest(KQOAuthRequest *request);    
     void executeAuthorizedRequest(KQOAuthRequest *request, int id);
+    /**
+     * Same as above for a request described as a value. The manager takes a KQOAuthRequest
+     * from its request pool when the request is sent and gives it back once the reply is
+     * handled.
+     */
+    void executeRequest(const KQOAuthRequestData &requestData);
+    void executeAuthorizedRequest(const KQOAuthRequestData &requestData, int id);
+    /**
+     * Returns a request from the request pool, or a new one if the pool is empty. It is reset
+     * and owned by the manager. Set it up with initRequest() and give it to executeRequest()
+     * or executeAuthorizedRequest(); it goes back to the pool once its reply is handled. A
+     * request that is not sent is given back with releaseRequest().
+     */
+    KQOAuthRequest *acquireRequest();
+    void releaseRequest(KQOAuthRequest *request);
     /**
      * Indicates to the user that KQOAuthManager should handle user authorization by
      * opening the user's default browser and parsing the reply from the service.
@@ -135,6 +152,8 @@ public:
      * Set setHandleUserAuthorization() to true and retrieve user authorization with void getUserAuthorization.
      */
     void sendAuthorizedRequest(QUrl requestEndpoint, const KQOAuthParameters &requestParameters);
+    // Same as above with an endpoint handle that is parsed and encoded only once.
+    void sendAuthorizedRequest(const KQOAuthEndpoint &requestEndpoint, const KQOAuthParameters &requestParameters);
 
     /**
      * Sets a custom QNetworkAccessManager to handle network requests. This method can be useful if the
@@ -151,6 +170,55 @@ public:
      */
     QNetworkAccessManager* networkManager() const;
 
+    /**
+     * Signs RSA-SHA1 requests on a pool of at most 'maxThreads' worker threads instead of in
+     * executeRequest(). The request is sent once its signature is ready, so the thread of the
+     * manager is not blocked by large keys. The request must not be changed until it is sent.
+     * The default, 0, signs synchronously.
+     */
+    void setRsaSigningThreads(int maxThreads);
+    int rsaSigningThreads() const;
+
+    /**
+     * Returns the number of RSA-SHA1 requests that are waiting for their signature.
+     */
+    int pendingRsaSignatures() const;
+
+    /**
+     * Sets how many RSA-SHA1 requests can wait for their signature at once. One more executed
+     * while that many are waiting is signed synchronously and sent right away. The default is 256.
+     */
+    void setMaxPendingRsaSignatures(int count);
+    int maxPendingRsaSignatures() const;
+
+    /**
+     * Sets how many finished requests the manager keeps for reuse. Reused requests keep
+     * their QObject, timer and parameter buffers. The default is 8, 0 disables the pool.
+     */
+    void setRequestPoolSize(int size);
+    int requestPoolSize() const;
+
+    /**
+     * Returns how many requests were taken from the pool and how many had to be created.
+     */
+    int requestPoolHits() const;
+    int requestPoolMisses() const;
+
+    /**
+     * Keeps the percent encoded form of up to 'size' recurring parameter keys and values, and
+     * copies it into the requests this manager executes instead of encoding them again. The
+     * least recently used ones are dropped first. The default, 0, disables the table.
+     */
+    void setParameterInternTableSize(int size);
+    int parameterInternTableSize() const;
+
+    /**
+     * Returns how many keys and values were found in the intern table and how many had to be
+     * encoded. Both start over when the table is disabled.
+     */
+    int parameterInternTableHits() const;
+    int parameterInternTableMisses() const;
+
 Q_SIGNALS:
     // This signal will be emitted after each request has got a reply.
     // Parameter is the raw response from the service.
@@ -190,6 +258,7 @@ private Q_SLOTS:
     void onVerificationReceived(QMultiMap<QString, QString> response);
     void slotError(QNetworkReply::NetworkError error);
     void requestTimeout();
+    void onRsaSignatureReady(int ticket, QByteArray signature);
 
 private:
     KQOAuthManagerPrivate *d_ptr;
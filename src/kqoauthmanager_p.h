@@ -22,6 +22,13 @@
 
 #include "kqoauthauthreplyserver.h"
 #include "kqoauthrequest.h"
+#include "kqoauthsigningcontext_p.h"
+#include "kqoauthrsasigningqueue_p.h"
+#include "kqoauthinterntable_p.h"
+
+#include <QHash>
+#include <QSet>
+#include <QPointer>
 
 class KQOAUTH_EXPORT KQOAuthManagerPrivate {
 
@@ -29,13 +36,30 @@ public:
     KQOAuthManagerPrivate(KQOAuthManager *parent);
     ~KQOAuthManagerPrivate();
 
-    QList< QPair<QString, QString> > createQueryParams(const KQOAuthParameters &requestParams);
+    QUrl urlWithQueryParams(const QUrl &url, const QByteArray &query);
     QMultiMap<QString, QString> createTokensFromResponse(QByteArray reply);
     bool setSuccessfulRequestToken(const QMultiMap<QString, QString> &request);
     bool setSuccessfulAuthorized(const QMultiMap<QString, QString> &request);
     void emitTokens();
     bool setupCallbackServer();
 
+    // Sends the request. executeRequest() and executeAuthorizedRequest() end up here once
+    // the request is ready to be signed.
+    void submitRequest(KQOAuthRequest *request);
+    void submitAuthorizedRequest(KQOAuthRequest *request, int id);
+    // Queues RSA-SHA1 signing on the worker pool. Returns false if the request should be
+    // signed and sent right away. When the queue is full the request is not sent and
+    // 'error' is set.
+    bool signAsynchronously(KQOAuthRequest *request, int id, bool authorized);
+
+    // Requests the manager created from KQOAuthRequestData or handed out by acquireRequest().
+    // They go back to the pool once their reply has been handled, or right away if they could
+    // not be sent.
+    KQOAuthRequest *createOwnedRequest(const KQOAuthRequestData &requestData);
+    KQOAuthRequest *takePooledRequest();
+    void releaseOwnedRequest(KQOAuthRequest *request);
+    void releaseOwnedRequestIfNotSent(KQOAuthRequest *request);
+
     KQOAuthManager::KQOAuthError error;
     KQOAuthRequest *r;                  // This request is used to cache the user sent request.
     KQOAuthRequest *opaqueRequest;       // This request is used to creating opaque convenience requests for the user.
@@ -69,6 +93,39 @@ public:
     QMap<QNetworkReply*, int> requestIds;
 
     QMap<KQOAuthRequest*, QNetworkReply*> requestMap;
+    QSet<KQOAuthRequest*> ownedRequests;
+
+    // Finished requests kept for reuse. They are reset when they are handed out again, since
+    // the slots handling their reply may still use them.
+    QList<KQOAuthRequest*> requestPool;
+    int requestPoolSize;
+    int requestPoolHits;
+    int requestPoolMisses;
+
+    // Encoded parameter keys and values shared by all requests executed by this manager.
+    // Null unless enabled with setParameterInternTableSize().
+    QSharedPointer<KQOAuthInternTable> internTable;
+
+    // HMAC-SHA1 signing contexts shared by all requests executed by this manager.
+    KQOAuthSigningContextCache signingContexts;
+
+    // RSA-SHA1 requests waiting for their signature from the worker pool, by ticket.
+    struct PendingRsaRequest {
+        PendingRsaRequest() : queuedRequest(0), id(0), authorized(false) {}
+
+        QPointer<KQOAuthRequest> request;
+        // The same request, kept to find it in 'requestsBeingSigned' even once it is deleted.
+        KQOAuthRequest *queuedRequest;
+        QByteArray baseString;
+        int id;
+        bool authorized;
+    };
+    KQOAuthRsaSigningQueue *rsaSigningQueue;
+    int rsaSigningThreads;
+    int maxPendingRsaSignatures;
+    QHash<int, PendingRsaRequest> pendingRsaRequests;
+    // The requests in 'pendingRsaRequests'.
+    QSet<KQOAuthRequest*> requestsBeingSigned;
 
     Q_DECLARE_PUBLIC(KQOAuthManager);
 };
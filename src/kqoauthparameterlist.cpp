@@ -0,0 +1,95 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "kqoauthparameterlist_p.h"
+
+KQOAuthParameterList::KQOAuthParameterList()
+{
+}
+
+KQOAuthParameterList::KQOAuthParameterList(const QMultiMap<QString, QString> &parameters) {
+    append(parameters);
+}
+
+KQOAuthParameterList::KQOAuthParameterList(const QList<Parameter> &parameters) {
+    this->parameters.reserve(parameters.size());
+    for (int i = 0; i < parameters.size(); i++) {
+        this->parameters.append(parameters.at(i));
+    }
+}
+
+int KQOAuthParameterList::size() const {
+    return parameters.size();
+}
+
+bool KQOAuthParameterList::isEmpty() const {
+    return parameters.isEmpty();
+}
+
+const KQOAuthParameterList::Parameter &KQOAuthParameterList::at(int i) const {
+    return parameters.at(i);
+}
+
+const KQOAuthParameterList::Parameter &KQOAuthParameterList::first() const {
+    Q_ASSERT(!parameters.isEmpty());
+    return parameters.at(0);
+}
+
+void KQOAuthParameterList::append(const Parameter &parameter) {
+    parameters.append(parameter);
+}
+
+void KQOAuthParameterList::append(const QMultiMap<QString, QString> &parameters) {
+    this->parameters.reserve(this->parameters.size() + parameters.size());
+    QMultiMap<QString, QString>::const_iterator it = parameters.constBegin();
+    for (; it != parameters.constEnd(); ++it) {
+        this->parameters.append(qMakePair(it.key(), it.value()));
+    }
+}
+
+void KQOAuthParameterList::append(const KQOAuthParameterList &parameters) {
+    this->parameters.append(parameters.parameters.constData(), parameters.size());
+}
+
+void KQOAuthParameterList::setValue(int i, const QString &value) {
+    parameters[i].second = value;
+}
+
+void KQOAuthParameterList::clear() {
+    parameters.resize(0);
+}
+
+// Values inserted for the same key are iterated newest first, so they are inserted from the
+// back to read them back in list order.
+QMultiMap<QString, QString> KQOAuthParameterList::toMap() const {
+    QMultiMap<QString, QString> map;
+    for (int i = parameters.size() - 1; i >= 0; i--) {
+        map.insert(parameters.at(i).first, parameters.at(i).second);
+    }
+    return map;
+}
+
+QList<KQOAuthParameterList::Parameter> KQOAuthParameterList::toList() const {
+    QList<Parameter> list;
+    list.reserve(parameters.size());
+    for (int i = 0; i < parameters.size(); i++) {
+        list.append(parameters.at(i));
+    }
+    return list;
+}
@@ -0,0 +1,67 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHPARAMETERLIST_P_H
+#define KQOAUTHPARAMETERLIST_P_H
+
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QMultiMap>
+#include <QVarLengthArray>
+
+#include "kqoauthglobals.h"
+
+/**
+ * Request parameters as key and value pairs, in the order they were added. Requests seldom
+ * have more than a few, so up to InlineSize of them are stored in the list itself and
+ * building one does not allocate.
+ */
+class KQOAUTH_EXPORT KQOAuthParameterList
+{
+public:
+    typedef QPair<QString, QString> Parameter;
+    enum { InlineSize = 8 };
+
+    KQOAuthParameterList();
+    // In the order of the map, read without the keys() and values() copies.
+    explicit KQOAuthParameterList(const QMultiMap<QString, QString> &parameters);
+    KQOAuthParameterList(const QList<Parameter> &parameters);
+
+    int size() const;
+    bool isEmpty() const;
+    const Parameter &at(int i) const;
+    const Parameter &first() const;
+
+    void append(const Parameter &parameter);
+    void append(const QMultiMap<QString, QString> &parameters);
+    void append(const KQOAuthParameterList &parameters);
+    // Replaces the value of the parameter at 'i' and keeps its key.
+    void setValue(int i, const QString &value);
+    void clear();
+
+    QMultiMap<QString, QString> toMap() const;
+    QList<Parameter> toList() const;
+
+private:
+    QVarLengthArray<Parameter, InlineSize> parameters;
+};
+
+#endif // KQOAUTHPARAMETERLIST_P_H
@@ -0,0 +1,287 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include "kqoauthpercentencoder_p.h"
+#include "kqoauthcpufeatures_p.h"
+
+#ifdef KQOAUTH_X86_DISPATCH
+#  include <immintrin.h>
+#endif
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+static inline bool isUnreserved(uchar c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+            || c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+static inline char *writeEscape(char *out, uchar c, bool twice) {
+    *out++ = '%';
+    if (twice) {
+        *out++ = '2';
+        *out++ = '5';
+    }
+    *out++ = hexDigits[c >> 4];
+    *out++ = hexDigits[c & 0xF];
+    return out;
+}
+
+static int reservedCountScalar(const uchar *data, int length) {
+    int count = 0;
+    for (int i = 0; i < length; i++) {
+        if (!isUnreserved(data[i])) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static char *encodeScalar(char *out, const uchar *data, int length, bool twice) {
+    for (int i = 0; i < length; i++) {
+        const uchar c = data[i];
+        if (isUnreserved(c)) {
+            *out++ = char(c);
+        } else {
+            out = writeEscape(out, c, twice);
+        }
+    }
+    return out;
+}
+
+#ifdef KQOAUTH_X86_DISPATCH
+
+// A block with some bytes to escape. Bit i of 'unreserved' is set when data[i] can be copied.
+// The runs between the escapes are copied whole.
+static inline char *encodeMixedBlock(char *out, const uchar *data, quint32 unreserved, int blockSize, bool twice) {
+    quint32 reserved = ~unreserved;
+    if (blockSize < 32) {
+        reserved &= (1u << blockSize) - 1;
+    }
+
+    int i = 0;
+    while (reserved != 0) {
+        const int next = __builtin_ctz(reserved);
+        memcpy(out, data + i, next - i);
+        out += next - i;
+        out = writeEscape(out, data[next], twice);
+        i = next + 1;
+        reserved &= reserved - 1;
+    }
+    memcpy(out, data + i, blockSize - i);
+    return out + blockSize - i;
+}
+
+// Unsigned range checks are done as "min(x - low, high - low) == x - low".
+__attribute__((target("sse2")))
+static inline quint32 unreservedMask16(const uchar *data) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+
+    const __m128i alpha = _mm_sub_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i digit = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    const __m128i dashOrDot = _mm_sub_epi8(bytes, _mm_set1_epi8('-'));
+
+    __m128i unreserved = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(25)), alpha);
+    unreserved = _mm_or_si128(unreserved, _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit));
+    unreserved = _mm_or_si128(unreserved, _mm_cmpeq_epi8(_mm_min_epu8(dashOrDot, _mm_set1_epi8(1)), dashOrDot));
+    unreserved = _mm_or_si128(unreserved, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+    unreserved = _mm_or_si128(unreserved, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('~')));
+
+    return quint32(_mm_movemask_epi8(unreserved));
+}
+
+__attribute__((target("sse2")))
+static int reservedCountSse2(const uchar *data, int length) {
+    int count = 0;
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        count += 16 - __builtin_popcount(unreservedMask16(data + i));
+    }
+    return count + reservedCountScalar(data + i, length - i);
+}
+
+__attribute__((target("sse2")))
+static char *encodeSse2(char *out, const uchar *data, int length, bool twice) {
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const quint32 unreserved = unreservedMask16(data + i);
+        if (unreserved == 0xFFFF) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out),
+                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)));
+            out += 16;
+        } else {
+            out = encodeMixedBlock(out, data + i, unreserved, 16, twice);
+        }
+    }
+    return encodeScalar(out, data + i, length - i, twice);
+}
+
+__attribute__((target("avx2")))
+static inline quint32 unreservedMask32(const uchar *data) {
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+
+    const __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i digit = _mm256_sub_epi8(bytes, _mm256_set1_epi8('0'));
+    const __m256i dashOrDot = _mm256_sub_epi8(bytes, _mm256_set1_epi8('-'));
+
+    __m256i unreserved = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(25)), alpha);
+    unreserved = _mm256_or_si256(unreserved, _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit));
+    unreserved = _mm256_or_si256(unreserved, _mm256_cmpeq_epi8(_mm256_min_epu8(dashOrDot, _mm256_set1_epi8(1)), dashOrDot));
+    unreserved = _mm256_or_si256(unreserved, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_')));
+    unreserved = _mm256_or_si256(unreserved, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('~')));
+
+    return quint32(_mm256_movemask_epi8(unreserved));
+}
+
+__attribute__((target("avx2,popcnt")))
+static int reservedCountAvx2(const uchar *data, int length) {
+    int count = 0;
+    int i = 0;
+    for (; i + 32 <= length; i += 32) {
+        count += 32 - __builtin_popcount(unreservedMask32(data + i));
+    }
+    return count + reservedCountScalar(data + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static char *encodeAvx2(char *out, const uchar *data, int length, bool twice) {
+    int i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const quint32 unreserved = unreservedMask32(data + i);
+        if (unreserved == 0xFFFFFFFFu) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out),
+                                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+            out += 32;
+        } else {
+            out = encodeMixedBlock(out, data + i, unreserved, 32, twice);
+        }
+    }
+    return encodeScalar(out, data + i, length - i, twice);
+}
+
+#endif // KQOAUTH_X86_DISPATCH
+
+static KQOAuthPercentEncoder::Implementation detectImplementation() {
+#ifdef KQOAUTH_X86_DISPATCH
+    if (KQOAuthCpuFeatures::hasAvx2()) {
+        return KQOAuthPercentEncoder::Avx2Implementation;
+    }
+    if (KQOAuthCpuFeatures::hasSse2()) {
+        return KQOAuthPercentEncoder::Sse2Implementation;
+    }
+#endif
+    return KQOAuthPercentEncoder::ScalarImplementation;
+}
+
+static KQOAuthPercentEncoder::Implementation detectedImplementation() {
+    static const KQOAuthPercentEncoder::Implementation detected = detectImplementation();
+    return detected;
+}
+
+bool KQOAuthPercentEncoder::isSupported(KQOAuthPercentEncoder::Implementation implementation) {
+    switch (implementation) {
+    case AutomaticImplementation:
+    case ScalarImplementation:
+        return true;
+#ifdef KQOAUTH_X86_DISPATCH
+    case Sse2Implementation:
+        return KQOAuthCpuFeatures::hasSse2();
+    case Avx2Implementation:
+        return KQOAuthCpuFeatures::hasAvx2();
+#endif
+    default:
+        return false;
+    }
+}
+
+KQOAuthPercentEncoder::Implementation KQOAuthPercentEncoder::implementation() {
+    return detectedImplementation();
+}
+
+// Automatic, or one the CPU does not support, means the detected implementation.
+static KQOAuthPercentEncoder::Implementation resolve(KQOAuthPercentEncoder::Implementation implementation) {
+    if (implementation == KQOAuthPercentEncoder::AutomaticImplementation
+        || !KQOAuthPercentEncoder::isSupported(implementation)) {
+        return detectedImplementation();
+    }
+    return implementation;
+}
+
+int KQOAuthPercentEncoder::encodedLength(const char *data, int length, bool twice,
+                                         Implementation implementation) {
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    int reserved;
+    switch (resolve(implementation)) {
+#ifdef KQOAUTH_X86_DISPATCH
+    case Avx2Implementation:
+        reserved = reservedCountAvx2(bytes, length);
+        break;
+    case Sse2Implementation:
+        reserved = reservedCountSse2(bytes, length);
+        break;
+#endif
+    default:
+        reserved = reservedCountScalar(bytes, length);
+        break;
+    }
+    return length + reserved * (twice ? 4 : 2);
+}
+
+char *KQOAuthPercentEncoder::encode(char *out, const char *data, int length, bool twice,
+                                    Implementation implementation) {
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    switch (resolve(implementation)) {
+#ifdef KQOAUTH_X86_DISPATCH
+    case Avx2Implementation:
+        return encodeAvx2(out, bytes, length, twice);
+    case Sse2Implementation:
+        return encodeSse2(out, bytes, length, twice);
+#endif
+    default:
+        return encodeScalar(out, bytes, length, twice);
+    }
+}
+
+void KQOAuthPercentEncoder::append(QByteArray &out, const char *data, int length, bool twice) {
+    const int start = out.size();
+    out.resize(start + encodedLength(data, length, twice));
+    encode(out.data() + start, data, length, twice);
+}
+
+void KQOAuthPercentEncoder::append(QByteArray &out, const QByteArray &data, bool twice) {
+    append(out, data.constData(), data.size(), twice);
+}
+
+void KQOAuthPercentEncoder::append(QByteArray &out, const QString &string, bool twice) {
+    const QByteArray utf8 = string.toUtf8();
+    append(out, utf8.constData(), utf8.size(), twice);
+}
+
+QByteArray KQOAuthPercentEncoder::encode(const QByteArray &data) {
+    QByteArray encoded;
+    append(encoded, data);
+    return encoded;
+}
+
+QByteArray KQOAuthPercentEncoder::encode(const QString &string) {
+    QByteArray encoded;
+    append(encoded, string);
+    return encoded;
+}
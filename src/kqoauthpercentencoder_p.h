@@ -0,0 +1,70 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHPERCENTENCODER_P_H
+#define KQOAUTHPERCENTENCODER_P_H
+
+#include <QString>
+#include <QByteArray>
+
+#include "kqoauthglobals.h"
+
+/**
+ * Percent encoding as required by http://oauth.net/core/1.0/#encoding_parameters:
+ * every byte outside the RFC 3986 unreserved set (ALPHA, DIGIT, '-', '.', '_', '~') is
+ * written as "%XX" with upper case hex digits. This is what QUrl::toPercentEncoding()
+ * does with its default arguments.
+ *
+ * Bytes are classified 16 (SSE2) or 32 (AVX2) at a time, and blocks that need no escaping
+ * are copied as they are. Short tails and CPUs without these extensions use portable C.
+ */
+class KQOAUTH_EXPORT KQOAuthPercentEncoder
+{
+public:
+    enum Implementation {
+        AutomaticImplementation = 0,    // Best one the CPU supports.
+        ScalarImplementation,           // Portable C.
+        Sse2Implementation,             // 16 bytes at a time.
+        Avx2Implementation              // 32 bytes at a time.
+    };
+
+    // With 'twice' set every escape is written as "%25XX", the same as encoding the encoded
+    // form once more. The signature base string needs that for its parameters.
+    // Tests and benchmarks pass an implementation; an unsupported one means the detected one.
+    static int encodedLength(const char *data, int length, bool twice = false,
+                             Implementation implementation = AutomaticImplementation);
+    // 'out' needs room for encodedLength() bytes. Returns the end of the written data.
+    static char *encode(char *out, const char *data, int length, bool twice = false,
+                        Implementation implementation = AutomaticImplementation);
+
+    static void append(QByteArray &out, const char *data, int length, bool twice = false);
+    static void append(QByteArray &out, const QByteArray &data, bool twice = false);
+    // The string is encoded as UTF-8.
+    static void append(QByteArray &out, const QString &string, bool twice = false);
+
+    static QByteArray encode(const QByteArray &data);
+    static QByteArray encode(const QString &string);
+
+    static bool isSupported(Implementation implementation);
+    // The implementation detected from the CPU features.
+    static Implementation implementation();
+};
+
+#endif // KQOAUTHPERCENTENCODER_P_H
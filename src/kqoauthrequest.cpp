@@ -17,6 +17,8 @@
  *  You should have received a copy of the GNU Lesser General Public License
  *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <string.h>
+
 #include <QByteArray>
 #include <QDateTime>
 #include <QCryptographicHash>
@@ -29,13 +31,35 @@
 #include "kqoauthrequest.h"
 #include "kqoauthrequest_p.h"
 #include "kqoauthutils.h"
+#include "kqoauthsigningcontext_p.h"
+#include "kqoauthsigner_p.h"
+#include "kqoauthbasestring_p.h"
+#include "kqoauthpercentencoder_p.h"
+#include "kqoauthrsakey_p.h"
+#include "kqoauthrequesttemplate_p.h"
+#include "kqoauthrequestdata_p.h"
+#include "kqoauthcredentials_p.h"
+#include "kqoautharena_p.h"
 #include "kqoauthglobals.h"
 
 
 //////////// Private d_ptr implementation /////////
 
 KQOAuthRequestPrivate::KQOAuthRequestPrivate() :
-    timeout(0)
+    requestSignatureMethod(KQOAuthRequest::HMAC_SHA1),
+    signer(0),
+    formParametersDirty(true),
+    formParametersEncodings(0),
+    fixedProtocolLayout(false),
+    protocolLayout(-1),
+    protocolParametersDirty(true),
+    fields(0),
+    fieldsDirty(true),
+    postRawDevice(0),
+    hashedDevice(0),
+    bodyHashEnabled(false),
+    timeout(0),
+    timer(0)
 {
 
 }
@@ -45,8 +69,120 @@ KQOAuthRequestPrivate::~KQOAuthRequestPrivate()
 
 }
 
+// The protocol parameters of each request type, in normalized order.
+static const KQOAuthRequestPrivate::ProtocolKey temporaryCredentialsKeys[] = {
+    KQOAuthRequestPrivate::CallbackKey,
+    KQOAuthRequestPrivate::ConsumerKeyKey,
+    KQOAuthRequestPrivate::NonceKey,
+    KQOAuthRequestPrivate::SignatureMethodKey,
+    KQOAuthRequestPrivate::TimestampKey,
+    KQOAuthRequestPrivate::VersionKey
+};
+
+static const KQOAuthRequestPrivate::ProtocolKey accessTokenKeys[] = {
+    KQOAuthRequestPrivate::ConsumerKeyKey,
+    KQOAuthRequestPrivate::NonceKey,
+    KQOAuthRequestPrivate::SignatureMethodKey,
+    KQOAuthRequestPrivate::TimestampKey,
+    KQOAuthRequestPrivate::TokenKey,
+    KQOAuthRequestPrivate::VerifierKey,
+    KQOAuthRequestPrivate::VersionKey
+};
+
+static const KQOAuthRequestPrivate::ProtocolKey authorizedRequestKeys[] = {
+    KQOAuthRequestPrivate::ConsumerKeyKey,
+    KQOAuthRequestPrivate::NonceKey,
+    KQOAuthRequestPrivate::SignatureMethodKey,
+    KQOAuthRequestPrivate::TimestampKey,
+    KQOAuthRequestPrivate::TokenKey,
+    KQOAuthRequestPrivate::VersionKey
+};
+
+static const KQOAuthRequestPrivate::ProtocolKey *protocolKeys(KQOAuthRequest::RequestType requestType, int *count) {
+    switch (requestType) {
+    case KQOAuthRequest::TemporaryCredentials:
+        *count = int(sizeof(temporaryCredentialsKeys) / sizeof(temporaryCredentialsKeys[0]));
+        return temporaryCredentialsKeys;
+    case KQOAuthRequest::AccessToken:
+        *count = int(sizeof(accessTokenKeys) / sizeof(accessTokenKeys[0]));
+        return accessTokenKeys;
+    case KQOAuthRequest::AuthorizedRequest:
+        *count = int(sizeof(authorizedRequestKeys) / sizeof(authorizedRequestKeys[0]));
+        return authorizedRequestKeys;
+    default:
+        *count = 0;
+        return 0;
+    }
+}
+
+const QString &KQOAuthRequestPrivate::protocolKey(ProtocolKey key) {
+    // Made into QStrings once, on first use, and then only shared.
+    static const QString keys[ProtocolKeyCount] = {
+        QString(OAUTH_KEY_BODY_HASH),
+        QString(OAUTH_KEY_CALLBACK),
+        QString(OAUTH_KEY_CONSUMER_KEY),
+        QString(OAUTH_KEY_NONCE),
+        QString(OAUTH_KEY_SIGNATURE_METHOD),
+        QString(OAUTH_KEY_TIMESTAMP),
+        QString(OAUTH_KEY_TOKEN),
+        QString(OAUTH_KEY_VERIFIER),
+        QString(OAUTH_KEY_VERSION)
+    };
+    return keys[key];
+}
+
+QString KQOAuthRequestPrivate::protocolValue(ProtocolKey key) const {
+    switch (key) {
+    case BodyHashKey:
+        return oauthBodyHash_;
+    case CallbackKey:
+        return oauthCallbackUrl.toString();  // This is so ugly that it is almost beautiful.
+    case ConsumerKeyKey:
+        return oauthConsumerKey;
+    case NonceKey:
+        return this->oauthNonce();
+    case SignatureMethodKey:
+        return signatureMethodString();
+    case TimestampKey:
+        return this->oauthTimestamp();
+    case TokenKey:
+        return oauthToken;
+    case VerifierKey:
+        return oauthVerifier;
+    case VersionKey:
+        return oauthVersion;
+    default:
+        return QString();
+    }
+}
+
+// oauth_body_hash, if there is one, comes before the parameters of the request type.
+int KQOAuthRequestPrivate::protocolSlotCount() const {
+    int count;
+    protocolKeys(requestType, &count);
+    return (oauthBodyHash_.isEmpty() ? 0 : 1) + count;
+}
+
+// The key of 'slot' in requestParameters, or ProtocolKeyCount if there is no such slot.
+KQOAuthRequestPrivate::ProtocolKey KQOAuthRequestPrivate::protocolSlotKey(int slot) const {
+    if (!oauthBodyHash_.isEmpty()) {
+        if (slot == 0) {
+            return BodyHashKey;
+        }
+        slot--;
+    }
+
+    int count;
+    const ProtocolKey *keys = protocolKeys(requestType, &count);
+    return (slot >= 0 && slot < count) ? keys[slot] : ProtocolKeyCount;
+}
+
 // This method will not include the "oauthSignature" paramater, since it is calculated from these parameters.
 void KQOAuthRequestPrivate::prepareRequest() {
+    if (fixedProtocolLayout) {
+        prepareProtocolSlots();
+        return;
+    }
 
     // If parameter list is not empty, we don't want to insert these values by
     // accident a second time. So giving up.
@@ -54,147 +190,266 @@ void KQOAuthRequestPrivate::prepareRequest() {
         return;
     }
 
-    switch ( requestType ) {
-    case KQOAuthRequest::TemporaryCredentials:
-        requestParameters.append( qMakePair( OAUTH_KEY_CALLBACK, oauthCallbackUrl.toString()) );  // This is so ugly that it is almost beautiful.
-        requestParameters.append( qMakePair( OAUTH_KEY_SIGNATURE_METHOD, oauthSignatureMethod) );
-        requestParameters.append( qMakePair( OAUTH_KEY_CONSUMER_KEY, oauthConsumerKey ));
-        requestParameters.append( qMakePair( OAUTH_KEY_VERSION, oauthVersion ));
-        requestParameters.append( qMakePair( OAUTH_KEY_TIMESTAMP, this->oauthTimestamp() ));
-        requestParameters.append( qMakePair( OAUTH_KEY_NONCE, this->oauthNonce() ));
-        break;
+    // The parameters are appended in normalized order, so requestBaseString() only merges
+    // them with the additional parameters instead of sorting them every time.
+    oauthBodyHash_ = this->oauthBodyHash();
+    const int count = protocolSlotCount();
+    for (int slot = 0; slot < count; slot++) {
+        const ProtocolKey key = protocolSlotKey(slot);
+        requestParameters.append( qMakePair( protocolKey(key), protocolValue(key) ));
+    }
+}
 
-    case KQOAuthRequest::AccessToken:
-        requestParameters.append( qMakePair( OAUTH_KEY_SIGNATURE_METHOD, oauthSignatureMethod ));
-        requestParameters.append( qMakePair( OAUTH_KEY_CONSUMER_KEY, oauthConsumerKey ));
-        requestParameters.append( qMakePair( OAUTH_KEY_VERSION, oauthVersion ));
-        requestParameters.append( qMakePair( OAUTH_KEY_TIMESTAMP, this->oauthTimestamp() ));
-        requestParameters.append( qMakePair( OAUTH_KEY_NONCE, this->oauthNonce() ));
-        requestParameters.append( qMakePair( OAUTH_KEY_VERIFIER, oauthVerifier ));
-        requestParameters.append( qMakePair( OAUTH_KEY_TOKEN, oauthToken ));
-        break;
+// The same parameters as prepareRequest(), for KQOAuthRequest_1. The slots are laid out in
+// normalized order only when the request type or the use of a body hash changes. Otherwise
+// the keys stay where they are and only the values are written.
+void KQOAuthRequestPrivate::prepareProtocolSlots() {
+    if (!protocolParametersDirty) {
+        return;
+    }
 
-    case KQOAuthRequest::AuthorizedRequest:
-        requestParameters.append( qMakePair( OAUTH_KEY_SIGNATURE_METHOD, oauthSignatureMethod ));
-        requestParameters.append( qMakePair( OAUTH_KEY_CONSUMER_KEY, oauthConsumerKey ));
-        requestParameters.append( qMakePair( OAUTH_KEY_VERSION, oauthVersion ));
-        requestParameters.append( qMakePair( OAUTH_KEY_TIMESTAMP, this->oauthTimestamp() ));
-        requestParameters.append( qMakePair( OAUTH_KEY_NONCE, this->oauthNonce() ));
-        requestParameters.append( qMakePair( OAUTH_KEY_TOKEN, oauthToken ));
-        break;
+    oauthBodyHash_ = this->oauthBodyHash();
+    const int layout = (requestType << 1) | (oauthBodyHash_.isEmpty() ? 0 : 1);
+    const bool layOut = layout != protocolLayout;
+    if (layOut) {
+        requestParameters.clear();
+        protocolLayout = layout;
+    }
 
-    default:
-        break;
+    const int count = protocolSlotCount();
+    for (int slot = 0; slot < count; slot++) {
+        const ProtocolKey key = protocolSlotKey(slot);
+        if (layOut) {
+            requestParameters.append(qMakePair(protocolKey(key), protocolValue(key)));
+        } else {
+            requestParameters.setValue(slot, protocolValue(key));
+        }
     }
-}
 
-void KQOAuthRequestPrivate::signRequest() {
-    QString signature = this->oauthSignature();
-    requestParameters.append( qMakePair( OAUTH_KEY_SIGNATURE, signature) );
+    Q_ASSERT(count == requestParameters.size());
+    protocolParametersDirty = false;
 }
 
 QString KQOAuthRequestPrivate::oauthSignature()  {
-    /**
-     * http://oauth.net/core/1.0/#anchor16
-     * The HMAC-SHA1 signature method uses the HMAC-SHA1 signature algorithm as defined in [RFC2104] where the
-     * Signature Base String is the text and the key is the concatenated values (each first encoded per Parameter
-     * Encoding) of the Consumer Secret and Token Secret, separated by an ‘&’ character (ASCII code 38) even if empty.
-     *
-     * RSA-SHA1 uses RSA to to generate the signature
-     **/
-    QByteArray baseString = this->requestBaseString();
-
-    QString signature;
-    if (this->oauthSignatureMethod == "RSA-SHA1") {
-        signature = KQOAuthUtils::rsa_sha1(baseString, oauthConsumerSecretKey);
-    } else { // Default: Use HMAC-SHA1
-        QString secret = QString(QUrl::toPercentEncoding(oauthConsumerSecretKey)) + "&" + QString(QUrl::toPercentEncoding(oauthTokenSecret));
-        signature = KQOAuthUtils::hmac_sha1(baseString, secret);
-    }
+    KQOAuthArena arena;
+    QByteArray signature;
+    appendOauthSignature(arena, signature);
+    return QString(signature);
+}
+
+// Appends the percent encoded signature to 'out' with the signer picked for the signature
+// method. The signature is written straight into the spare capacity of 'out', so a reserved
+// buffer is never reallocated. The base string, if the method needs one, is built in 'arena'.
+void KQOAuthRequestPrivate::appendOauthSignature(KQOAuthArena &arena, QByteArray &out) {
+    const int start = out.size();
+    // A request without a signature method is still signed, the way it used to be.
+    KQOAuthSigner::SignFunction sign = signer != 0 ? signer : KQOAuthSigner::forMethod(KQOAuthRequest::HMAC_SHA1);
+    sign(*this, arena, out);
 
     if (debugOutput) {
         qDebug() << "========== KQOAuthRequest has the following signature:";
-        qDebug() << " * Signature : " << QUrl::toPercentEncoding(signature) << "\n";
+        qDebug() << " * Signature : " << out.mid(start) << "\n";
+    }
+}
+
+const KQOAuthParameterList &KQOAuthRequestPrivate::fixedParameters() const {
+    return requestTemplate.d.constData()->fixedParameters;
+}
+
+// The parameters of the template were encoded by it, so only the additional ones are encoded.
+const KQOAuthEncodedParameters &KQOAuthRequestPrivate::formParameters() const {
+    if (formParametersDirty) {
+        encodedFormParameters = KQOAuthEncodedParameters(requestTemplate.d.constData()->encodedFixedParameters,
+                                                         additionalParameters, internTable.data());
+        formParametersDirty = false;
+        formParametersEncodings++;
+    }
+    return encodedFormParameters;
+}
+
+// True if the request still has the consumer key, token, signature method and version of its
+// template, so the parameters the template encoded can be used as they are.
+bool KQOAuthRequestPrivate::usesRequestTemplate() const {
+    const KQOAuthRequestTemplatePrivate *t = requestTemplate.d.constData();
+
+    return requestType == KQOAuthRequest::AuthorizedRequest
+            && !t->encodedParameters.isEmpty()
+            && t->consumerKey == oauthConsumerKey
+            && t->token == oauthToken
+            && t->signatureMethod == requestSignatureMethod
+            && t->version == oauthVersion;
+}
+
+// True if the request still has the consumer key, token and signature method of the
+// credentials it was given.
+bool KQOAuthRequestPrivate::usesCredentials() const {
+    const KQOAuthCredentialsPrivate *c = credentials.d.constData();
+
+    return requestType == KQOAuthRequest::AuthorizedRequest
+            && !c->signatureMethodString.isEmpty()
+            && c->consumerKey == oauthConsumerKey
+            && c->token == oauthToken
+            && c->signatureMethod == requestSignatureMethod
+            && c->version == oauthVersion;
+}
+
+// The protocol parameters the template or the credentials of the request encoded, or none if
+// it uses neither.
+const KQOAuthEncodedParameters &KQOAuthRequestPrivate::encodedProtocolParameters() const {
+    static const KQOAuthEncodedParameters none;
+
+    if (usesRequestTemplate()) {
+        return requestTemplate.d.constData()->encodedParameters;
+    }
+    if (usesCredentials()) {
+        return credentials.d.constData()->encodedParameters;
+    }
+    return none;
+}
+
+// The protocol parameters of an authorized request that change from one request to the next,
+// in normalized order. The others are encoded by a template or credentials.
+KQOAuthParameterList KQOAuthRequestPrivate::changingProtocolParameters() const {
+    KQOAuthParameterList parameters;
+    if (!oauthBodyHash_.isEmpty()) {
+        parameters.append( qMakePair( protocolKey(BodyHashKey), oauthBodyHash_ ));
     }
-    return QString( QUrl::toPercentEncoding(signature) );
+    parameters.append( qMakePair( protocolKey(NonceKey), this->oauthNonce() ));
+    parameters.append( qMakePair( protocolKey(TimestampKey), this->oauthTimestamp() ));
+    return parameters;
 }
 
-bool normalizedParameterSort(const QPair<QString, QString> &left, const QPair<QString, QString> &right) {
-    QString keyLeft = left.first;
-    QString valueLeft = left.second;
-    QString keyRight = right.first;
-    QString valueRight = right.second;
+void KQOAuthRequestPrivate::setCredentials(const KQOAuthCredentials &requestCredentials) {
+    const KQOAuthCredentialsPrivate *c = requestCredentials.d.constData();
 
-    if(keyLeft == keyRight) {
-        return (valueLeft < valueRight);
+    credentials = requestCredentials;
+    oauthConsumerKey = c->consumerKey;
+    oauthConsumerSecretKey = c->consumerSecretKey;
+    oauthToken = c->token;
+    oauthTokenSecret = c->tokenSecret;
+    if (c->signatureMethodString.isEmpty()) {
+        signer = 0;
     } else {
-        return (keyLeft < keyRight);
+        setSignatureMethod(c->signatureMethod);
+    }
+    if (!c->signingContext.isNull()) {
+        signingContext = c->signingContext;
     }
 }
-QByteArray KQOAuthRequestPrivate::requestBaseString() {
-    QByteArray baseString;
 
-    // Every request has these as the commont parameters.
-    baseString.append( oauthHttpMethodString.toUtf8() + "&");                                                     // HTTP method
-    baseString.append( QUrl::toPercentEncoding( oauthRequestEndpoint.toString(QUrl::RemoveQuery) ) + "&" ); // The path and query components
+void KQOAuthRequestPrivate::setSignatureMethod(KQOAuthRequest::RequestSignatureMethod method) {
+    requestSignatureMethod = method;
+    signer = KQOAuthSigner::forMethod(method);
+}
 
-    QList< QPair<QString, QString> > baseStringParameters;
-    baseStringParameters.append(requestParameters);
-    baseStringParameters.append(additionalParameters);
+// The oauth_signature_method value, or an empty string if no method is set.
+const QString &KQOAuthRequestPrivate::signatureMethodString() const {
+    static const QString none;
+    return signer != 0 ? KQOAuthSigner::methodName(requestSignatureMethod) : none;
+}
 
-    // Sort the request parameters. These parameters have been
-    // initialized earlier.
-    qSort(baseStringParameters.begin(),
-          baseStringParameters.end(),
-          normalizedParameterSort
-          );
+// The fragment the credentials encoded already for the parameter in 'slot', or 0.
+const QByteArray *KQOAuthRequestPrivate::credentialsHeaderParameter(int slot) const {
+    const KQOAuthCredentialsPrivate *c = credentials.d.constData();
+    if (c->signatureMethodString.isEmpty()) {
+        return 0;
+    }
 
-    // Last append the request parameters correctly encoded.
-    baseString.append( encodedParamaterList(baseStringParameters) );
+    const QString &value = requestParameters.at(slot).second;
+    switch (protocolSlotKey(slot)) {
+    case ConsumerKeyKey:
+        return value == c->consumerKey ? &c->consumerKeyHeader : 0;
+    case TokenKey:
+        return value == c->token ? &c->tokenHeader : 0;
+    case SignatureMethodKey:
+        return value == c->signatureMethodString ? &c->signatureMethodHeader : 0;
+    case VersionKey:
+        return value == c->version ? &c->versionHeader : 0;
+    default:
+        return 0;
+    }
+}
 
-    if (debugOutput) {
-        qDebug() << "========== KQOAuthRequest has the following base string:";
-        qDebug() << baseString << "\n";
+// key="percent encoded value" for the Authorization header. The fragments of the credentials
+// are encoded already and shared.
+QByteArray KQOAuthRequestPrivate::headerParameter(KQOAuthArena &arena, int slot) const {
+    const QByteArray *prepared = credentialsHeaderParameter(slot);
+    if (prepared != 0) {
+        return *prepared;
     }
 
-    return baseString;
+    int length;
+    const char *fragment = headerFragment(arena, slot, &length);
+    return QByteArray(fragment, length);
 }
 
-QByteArray KQOAuthRequestPrivate::encodedParamaterList(const QList< QPair<QString, QString> > &parameters) {
-    QByteArray resultList;
+// Same as above, written to 'arena' unless the credentials have it. Not null terminated.
+const char *KQOAuthRequestPrivate::headerFragment(KQOAuthArena &arena, int slot, int *length) const {
+    const QByteArray *prepared = credentialsHeaderParameter(slot);
+    if (prepared != 0) {
+        *length = prepared->size();
+        return prepared->constData();
+    }
 
-    bool first = true;
-    QPair<QString, QString> parameter;
+    const QPair<QString, QString> &parameter = requestParameters.at(slot);
+    int keyLength;
+    const char *key = arena.utf8(parameter.first, &keyLength);
+    int valueLength;
+    const char *value = arena.utf8(parameter.second, &valueLength);
+
+    *length = keyLength + 3 + KQOAuthPercentEncoder::encodedLength(value, valueLength);
+    char *fragment = arena.allocate<char>(*length);
+    char *out = fragment;
+    memcpy(out, key, keyLength);
+    out += keyLength;
+    *out++ = '=';
+    *out++ = '"';
+    out = KQOAuthPercentEncoder::encode(out, value, valueLength);
+    *out = '"';
+    return fragment;
+}
 
-    // Do the debug output.
+QByteArray KQOAuthRequestPrivate::requestBaseString() {
+    KQOAuthArena arena;
+    int length;
+    const char *baseString = requestBaseString(arena, &length);
+    return QByteArray(baseString, length);
+}
+
+const char *KQOAuthRequestPrivate::requestBaseString(KQOAuthArena &arena, int *length) {
     if (debugOutput) {
         qDebug() << "========== KQOAuthRequest has the following parameters:";
-    }
-    foreach (parameter, parameters) {
-        if(!first) {
-            resultList.append( "&" );
-        } else {
-            first = false;
-        }
-
-        // Here we don't need to explicitely encode the strings to UTF-8 since
-        // QUrl::toPercentEncoding() takes care of that for us.
-        resultList.append( QUrl::toPercentEncoding(parameter.first)     // Parameter key
-                           + "="
-                           + QUrl::toPercentEncoding(parameter.second)  // Parameter value
-                          );
-        if (debugOutput) {
+        KQOAuthParameterList parameters = requestParameters;
+        parameters.append(fixedParameters());
+        parameters.append(additionalParameters);
+        for (int i = 0; i < parameters.size(); i++) {
             qDebug() << " * "
-                     << parameter.first
+                     << parameters.at(i).first
                      << " : "
-                     << parameter.second;
+                     << parameters.at(i).second;
         }
+        qDebug() << "\n";
     }
+
+    // HTTP method and the endpoint, encoded once by the endpoint handle, followed by the
+    // request parameters correctly encoded and sorted, written in one go. The form parameters
+    // are encoded already, the same bytes as in the body or the query.
+    const QByteArray prefix = oauthRequestEndpoint.baseStringPrefix(oauthHttpMethod);
+    // Parameters a template or the credentials encoded are merged in as they are, along with
+    // only the protocol parameters that change.
+    const KQOAuthEncodedParameters &encodedProtocolParameters = this->encodedProtocolParameters();
+    const char *baseString = KQOAuthBaseStringBuilder::build(arena, length, prefix,
+                                                             encodedProtocolParameters, formParameters(),
+                                                             encodedProtocolParameters.isEmpty()
+                                                                 ? requestParameters
+                                                                 : changingProtocolParameters());
+
     if (debugOutput) {
-        qDebug() << "\n";
+        qDebug() << "========== KQOAuthRequest has the following base string:";
+        qDebug() << QByteArray(baseString, *length) << "\n";
     }
 
-    return QUrl::toPercentEncoding(resultList);
+    return baseString;
 }
 
 QString KQOAuthRequestPrivate::oauthTimestamp() const {
@@ -220,55 +475,88 @@ QString KQOAuthRequestPrivate::oauthNonce() const {
     return QString::number(qrand());
 }
 
+// http://oauth.googlecode.com/svn/spec/ext/body_hash/1.0/oauth-bodyhash.html
+// Form encoded bodies are signed as parameters and never get a body hash. Requests that
+// are not posted have an empty body.
+QString KQOAuthRequestPrivate::oauthBodyHash() const {
+    if (!bodyHashEnabled || contentType == "application/x-www-form-urlencoded") {
+        return QString();
+    }
+
+    if (oauthHttpMethod != KQOAuthRequest::POST) {
+        return KQOAuthUtils::bodyHash(QByteArray());
+    }
+
+    // The device is read only once. setRawData() drops the hash, like the form parameters.
+    if (postRawDevice != 0) {
+        if (hashedDevice != postRawDevice) {
+            deviceBodyHash = KQOAuthUtils::bodyHash(postRawDevice);
+            hashedDevice = deviceBodyHash.isEmpty() ? 0 : postRawDevice;
+        }
+        return deviceBodyHash;
+    }
+
+    return KQOAuthUtils::bodyHash(postRawData);
+}
+
+void KQOAuthRequestPrivate::clearDeviceBodyHash() {
+    hashedDevice = 0;
+    deviceBodyHash.clear();
+}
+
 bool KQOAuthRequestPrivate::validateRequest() const {
+    int requiredFields = 0;
     switch ( requestType ) {
     case KQOAuthRequest::TemporaryCredentials:
-        if (oauthRequestEndpoint.isEmpty()
-            || oauthConsumerKey.isEmpty()
-            || oauthNonce_.isEmpty()
-            || oauthSignatureMethod.isEmpty()
-            || oauthTimestamp_.isEmpty()
-            || oauthVersion.isEmpty())
-        {
-            return false;
-        }
-        return true;
+        requiredFields = TemporaryCredentialsFields;
+        break;
 
     case KQOAuthRequest::AccessToken:
-        if (oauthRequestEndpoint.isEmpty()
-            || oauthVerifier.isEmpty()
-            || oauthConsumerKey.isEmpty()
-            || oauthNonce_.isEmpty()
-            || oauthSignatureMethod.isEmpty()
-            || oauthTimestamp_.isEmpty()
-            || oauthToken.isEmpty()
-            || oauthTokenSecret.isEmpty()
-            || oauthVersion.isEmpty())
-        {
-            return false;
-        }
-        return true;
+        requiredFields = AccessTokenFields;
+        break;
 
     case KQOAuthRequest::AuthorizedRequest:
-        if (oauthRequestEndpoint.isEmpty()
-            || oauthConsumerKey.isEmpty()
-            || oauthNonce_.isEmpty()
-            || oauthSignatureMethod.isEmpty()
-            || oauthTimestamp_.isEmpty()
-            || oauthToken.isEmpty()
-            || oauthTokenSecret.isEmpty()
-            || oauthVersion.isEmpty())
-        {
-            return false;
-        }
-        return true;
+        requiredFields = AuthorizedRequestFields;
+        break;
 
     default:
         return false;
     }
 
-    // We should not come here.
-    return false;
+    return (presentFields() & requiredFields) == requiredFields;
+}
+
+// The fields are only looked at again after a setter has changed something.
+int KQOAuthRequestPrivate::presentFields() const {
+    if (!fieldsDirty) {
+        return fields;
+    }
+
+    fields = 0;
+    if (!oauthRequestEndpoint.isEmpty())    fields |= EndpointField;
+    if (!oauthConsumerKey.isEmpty())        fields |= ConsumerKeyField;
+    if (!oauthNonce_.isEmpty())             fields |= NonceField;
+    if (signer != 0)                        fields |= SignatureMethodField;
+    if (!oauthTimestamp_.isEmpty())         fields |= TimestampField;
+    if (!oauthVersion.isEmpty())            fields |= VersionField;
+    if (!oauthToken.isEmpty())              fields |= TokenField;
+    if (!oauthTokenSecret.isEmpty())        fields |= TokenSecretField;
+    if (!oauthVerifier.isEmpty())           fields |= VerifierField;
+    fieldsDirty = false;
+
+    return fields;
+}
+
+// Called whenever something the signature or the validation depends on changes.
+void KQOAuthRequestPrivate::setDirty() {
+    fieldsDirty = true;
+    if (fixedProtocolLayout) {
+        protocolParametersDirty = true;
+    } else {
+        requestParameters.clear();
+    }
+    signedParameters.clear();
+    signedHeader.clear();
 }
 
 //////////// Public implementation ////////////////
@@ -277,9 +565,7 @@ KQOAuthRequest::KQOAuthRequest(QObject *parent) :
     QObject(parent),
     d_ptr(new KQOAuthRequestPrivate)
 {
-    Q_D(KQOAuthRequest);
     d_ptr->debugOutput = false;  // No debug output by default.
-    connect(&(d->timer), SIGNAL(timeout()), this, SIGNAL(requestTimedout()));
 }
 
 KQOAuthRequest::~KQOAuthRequest()
@@ -288,6 +574,10 @@ KQOAuthRequest::~KQOAuthRequest()
 }
 
 void KQOAuthRequest::initRequest(KQOAuthRequest::RequestType type, const QUrl &requestEndpoint) {
+    initRequest(type, KQOAuthEndpoint(requestEndpoint));
+}
+
+void KQOAuthRequest::initRequest(KQOAuthRequest::RequestType type, const KQOAuthEndpoint &requestEndpoint) {
     Q_D(KQOAuthRequest);
 
     if (!requestEndpoint.isValid()) {
@@ -313,92 +603,98 @@ void KQOAuthRequest::initRequest(KQOAuthRequest::RequestType type, const QUrl &r
     d->oauthVersion = "1.0"; // Currently supports only version 1.0
 
     d->contentType = "application/x-www-form-urlencoded";
+    d->setDirty();
+}
+
+void KQOAuthRequest::initRequest(const KQOAuthRequestTemplate &requestTemplate) {
+    Q_D(KQOAuthRequest);
+
+    if (!requestTemplate.isValid()) {
+        qWarning() << "Request template is not valid. Ignoring. This request might not work.";
+        return;
+    }
+
+    initRequest(KQOAuthRequest::AuthorizedRequest, requestTemplate.endpoint());
+    this->setConsumerKey(requestTemplate.consumerKey());
+    this->setToken(requestTemplate.token());
+    this->setSignatureMethod(requestTemplate.signatureMethod());
+    d->requestTemplate = requestTemplate;
+    d->formParametersDirty = true;
 }
 
 void KQOAuthRequest::setConsumerKey(const QString &consumerKey) {
     Q_D(KQOAuthRequest);
     d->oauthConsumerKey = consumerKey;
+    d->setDirty();
+}
+
+void KQOAuthRequest::setCredentials(const KQOAuthCredentials &credentials) {
+    Q_D(KQOAuthRequest);
+    d->setCredentials(credentials);
+    d->setDirty();
+}
+
+KQOAuthCredentials KQOAuthRequest::credentials() const {
+    Q_D(const KQOAuthRequest);
+    return d->credentials;
 }
 
 void KQOAuthRequest::setConsumerSecretKey(const QString &consumerSecretKey) {
     Q_D(KQOAuthRequest);
     d->oauthConsumerSecretKey = consumerSecretKey;
+    d->setDirty();
 }
 
 void KQOAuthRequest::setCallbackUrl(const QUrl &callbackUrl) {
     Q_D(KQOAuthRequest);
 
     d->oauthCallbackUrl = callbackUrl;
+    d->setDirty();
 }
 
 void KQOAuthRequest::setSignatureMethod(KQOAuthRequest::RequestSignatureMethod requestMethod) {
     Q_D(KQOAuthRequest);
-    QString requestMethodString;
 
-    switch (requestMethod) {
-    case KQOAuthRequest::PLAINTEXT:
-        requestMethodString = "PLAINTEXT";
-        break;
-    case KQOAuthRequest::HMAC_SHA1:
-        requestMethodString = "HMAC-SHA1";
-        break;
-    case KQOAuthRequest::RSA_SHA1:
-        requestMethodString = "RSA-SHA1";
-        break;
-    default:
+    if (KQOAuthSigner::forMethod(requestMethod) == 0) {
         // We should not come here
         qWarning() << "Invalid signature method set.";
-        break;
     }
 
-    d->oauthSignatureMethod = requestMethodString;
-    d->requestSignatureMethod = requestMethod;
+    d->setSignatureMethod(requestMethod);
+    d->setDirty();
 }
 
 void KQOAuthRequest::setTokenSecret(const QString &tokenSecret) {
     Q_D(KQOAuthRequest);
 
     d->oauthTokenSecret = tokenSecret;
+    d->setDirty();
 }
 
 void KQOAuthRequest::setToken(const QString &token) {
     Q_D(KQOAuthRequest);
 
     d->oauthToken = token;
+    d->setDirty();
 }
 
 void KQOAuthRequest::setVerifier(const QString &verifier) {
     Q_D(KQOAuthRequest);
 
     d->oauthVerifier = verifier;
+    d->setDirty();
 }
 
 
 void KQOAuthRequest::setHttpMethod(KQOAuthRequest::RequestHttpMethod httpMethod) {
     Q_D(KQOAuthRequest);
 
-    QString requestHttpMethodString;
-
-    switch (httpMethod) {
-    case KQOAuthRequest::GET:
-        requestHttpMethodString = "GET";
-        break;
-    case KQOAuthRequest::POST:
-        requestHttpMethodString = "POST";
-        break;
-    case KQOAuthRequest::HEAD:
-        requestHttpMethodString = "HEAD";
-        break;
-    case KQOAuthRequest::DELETE:
-        requestHttpMethodString = "DELETE";
-        break;
-    default:
+    if (httpMethod < KQOAuthRequest::GET || httpMethod > KQOAuthRequest::DELETE) {
         qWarning() << "Invalid HTTP method set.";
-        break;
     }
 
     d->oauthHttpMethod = httpMethod;
-    d->oauthHttpMethodString = requestHttpMethodString;
+    d->setDirty();
 }
 
 KQOAuthRequest::RequestHttpMethod KQOAuthRequest::httpMethod() const {
@@ -410,27 +706,17 @@ KQOAuthRequest::RequestHttpMethod KQOAuthRequest::httpMethod() const {
 void KQOAuthRequest::setAdditionalParameters(const KQOAuthParameters &additionalParams) {
     Q_D(KQOAuthRequest);
 
-    QList<QString> additionalKeys = additionalParams.keys();
-    QList<QString> additionalValues = additionalParams.values();
-
-    int i=0;
-    foreach(QString key, additionalKeys) {
-        QString value = additionalValues.at(i);
-        d->additionalParameters.append( qMakePair(key, value) );
-        i++;
-    }
+    d->additionalParameters.append(additionalParams);
+    d->formParametersDirty = true;
+    d->setDirty();
 }
 
 KQOAuthParameters KQOAuthRequest::additionalParameters() const {
     Q_D(const KQOAuthRequest);
 
-    QMultiMap<QString, QString> additionalParams;
-    for(int i=0; i<d->additionalParameters.size(); i++) {
-        additionalParams.insert(d->additionalParameters.at(i).first,
-                                d->additionalParameters.at(i).second);
-    }
-
-    return additionalParams;
+    KQOAuthParameterList parameters = d->fixedParameters();
+    parameters.append(d->additionalParameters);
+    return parameters.toMap();
 }
 
 KQOAuthRequest::RequestType KQOAuthRequest::requestType() const {
@@ -439,6 +725,11 @@ KQOAuthRequest::RequestType KQOAuthRequest::requestType() const {
 }
 
 QUrl KQOAuthRequest::requestEndpoint() const {
+    Q_D(const KQOAuthRequest);
+    return d->oauthRequestEndpoint.url();
+}
+
+KQOAuthEndpoint KQOAuthRequest::endpoint() const {
     Q_D(const KQOAuthRequest);
     return d->oauthRequestEndpoint;
 }
@@ -446,6 +737,11 @@ QUrl KQOAuthRequest::requestEndpoint() const {
 QList<QByteArray> KQOAuthRequest::requestParameters() {
     Q_D(KQOAuthRequest);
 
+    // Signed once, until a setter changes the request.
+    if (!d->signedParameters.isEmpty()) {
+        return d->signedParameters;
+    }
+
     QList<QByteArray> requestParamList;
 
     d->prepareRequest();
@@ -453,22 +749,70 @@ QList<QByteArray> KQOAuthRequest::requestParameters() {
         qWarning() << "Request is not valid! I will still sign it, but it will probably not work.";
     }
 
-    d->signRequest();
+    // Everything made on the way lives in the arena and is freed in one go on return.
+    KQOAuthArena arena;
+    requestParamList.reserve(d->requestParameters.size() + 1);
+    for (int i = 0; i < d->requestParameters.size(); i++) {
+        requestParamList.append(d->headerParameter(arena, i));
+    }
+
+    // The signature is written directly into its header fragment, it is already percent encoded.
+    QByteArray signatureParam;
+    signatureParam.reserve(qstrlen(OAUTH_KEY_SIGNATURE.latin1()) + 3 + KQOAuthUtils::MaxPercentEncodedSha1Length);
+    signatureParam.append(OAUTH_KEY_SIGNATURE.latin1());
+    signatureParam.append("=\"");
+    d->appendOauthSignature(arena, signatureParam);
+    signatureParam.append('"');
+    requestParamList.append(signatureParam);
 
-    QPair<QString, QString> requestParam;
-    QString param;
-    QString value;
-    foreach (requestParam, d->requestParameters) {
-        param = requestParam.first;
-        value = requestParam.second;
-        if (param != OAUTH_KEY_SIGNATURE) {
-            value = QUrl::toPercentEncoding(value);
-        }
+    d->signedParameters = requestParamList;
+    return requestParamList;
+}
 
-        requestParamList.append(QString(param + "=\"" + value +"\"").toUtf8());
+// The fragments are measured first, so the header is written into one buffer. With HMAC-SHA1
+// that is the only allocation.
+QByteArray KQOAuthRequest::authorizationHeader() {
+    Q_D(KQOAuthRequest);
+
+    // Signed once, until a setter changes the request.
+    if (!d->signedHeader.isEmpty()) {
+        return d->signedHeader;
     }
 
-    return requestParamList;
+    d->prepareRequest();
+    if (!isValid() ) {
+        qWarning() << "Request is not valid! I will still sign it, but it will probably not work.";
+    }
+
+    static const char scheme[] = "OAuth ";
+    static const char separator[] = ", ";
+    const char *signatureKey = OAUTH_KEY_SIGNATURE.latin1();
+    const int signatureKeyLength = qstrlen(signatureKey);
+
+    KQOAuthArena arena;
+    const int count = d->requestParameters.size();
+    const char **fragments = arena.allocate<const char *>(count);
+    int *fragmentLengths = arena.allocate<int>(count);
+    int length = sizeof(scheme) - 1 + signatureKeyLength + 3 + KQOAuthUtils::MaxPercentEncodedSha1Length;
+    for (int i = 0; i < count; i++) {
+        fragments[i] = d->headerFragment(arena, i, &fragmentLengths[i]);
+        length += fragmentLengths[i] + sizeof(separator) - 1;
+    }
+
+    QByteArray header;
+    header.reserve(length);
+    header.append(scheme, sizeof(scheme) - 1);
+    for (int i = 0; i < count; i++) {
+        header.append(fragments[i], fragmentLengths[i]);
+        header.append(separator, sizeof(separator) - 1);
+    }
+    header.append(signatureKey, signatureKeyLength);
+    header.append("=\"", 2);
+    d->appendOauthSignature(arena, header);
+    header.append('"');
+
+    d->signedHeader = header;
+    return header;
 }
 
 QString KQOAuthRequest::contentType()
@@ -481,6 +825,7 @@ void KQOAuthRequest::setContentType(const QString &contentType)
 {
     Q_D(KQOAuthRequest);
     d->contentType = contentType;
+    d->setDirty();
 }
 
 QByteArray KQOAuthRequest::rawData()
@@ -493,27 +838,44 @@ void KQOAuthRequest::setRawData(const QByteArray &rawData)
 {
     Q_D(KQOAuthRequest);
     d->postRawData = rawData;
+    d->postRawDevice = 0;
+    d->clearDeviceBodyHash();
+    d->setDirty();
 }
 
-QByteArray KQOAuthRequest::requestBody() const {
+QIODevice *KQOAuthRequest::rawDataDevice() const
+{
     Q_D(const KQOAuthRequest);
+    return d->postRawDevice;
+}
 
-    QByteArray postBodyContent;
-    bool first = true;
-    for(int i=0; i < d->additionalParameters.size(); i++) {
-        if(!first) {
-            postBodyContent.append("&");
-        } else {
-            first = false;
-        }
+void KQOAuthRequest::setRawData(QIODevice *device)
+{
+    Q_D(KQOAuthRequest);
+    d->postRawData.clear();
+    d->postRawDevice = device;
+    d->clearDeviceBodyHash();
+    d->setDirty();
+}
 
-        QString key = d->additionalParameters.at(i).first;
-        QString value = d->additionalParameters.at(i).second;
+void KQOAuthRequest::setBodyHashEnabled(bool enabled)
+{
+    Q_D(KQOAuthRequest);
+    d->bodyHashEnabled = enabled;
+    d->setDirty();
+}
 
-        postBodyContent.append(QUrl::toPercentEncoding(key) + QString("=").toUtf8() +
-                               QUrl::toPercentEncoding(value));
-    }
-    return postBodyContent;
+bool KQOAuthRequest::isBodyHashEnabled() const
+{
+    Q_D(const KQOAuthRequest);
+    return d->bodyHashEnabled;
+}
+
+QByteArray KQOAuthRequest::requestBody() const {
+    Q_D(const KQOAuthRequest);
+
+    // Shared with the query and encoded once for the signature.
+    return d->formParameters().form();
 }
 
 bool KQOAuthRequest::isValid() const {
@@ -530,20 +892,28 @@ void KQOAuthRequest::setTimeout(int timeoutMilliseconds) {
 void KQOAuthRequest::clearRequest() {
     Q_D(KQOAuthRequest);
 
-    d->oauthRequestEndpoint = "";
-    d->oauthHttpMethodString = "";
-    d->oauthConsumerKey = "";
-    d->oauthConsumerSecretKey = "";
-    d->oauthToken = "";
-    d->oauthTokenSecret = "";
-    d->oauthSignatureMethod = "";
-    d->oauthCallbackUrl = "";
-    d->oauthVerifier = "";
-    d->oauthTimestamp_ = "";
-    d->oauthNonce_ = "";
-    d->requestParameters.clear();
+    // Empty endpoints, templates and credentials share one private, and the parameter lists
+    // keep their buffers, so clearing does not allocate.
+    d->oauthRequestEndpoint = KQOAuthEndpoint();
+    d->requestTemplate = KQOAuthRequestTemplate();
+    d->credentials = KQOAuthCredentials();
+    d->oauthConsumerKey.clear();
+    d->oauthConsumerSecretKey.clear();
+    d->oauthToken.clear();
+    d->oauthTokenSecret.clear();
+    d->signer = 0;
+    d->oauthCallbackUrl.clear();
+    d->oauthVerifier.clear();
+    d->oauthTimestamp_.clear();
+    d->oauthNonce_.clear();
+    d->oauthBodyHash_.clear();
+    d->postRawDevice = 0;
+    d->clearDeviceBodyHash();
+    d->bodyHashEnabled = false;
     d->additionalParameters.clear();
+    d->formParametersDirty = true;
     d->timeout = 0;
+    d->setDirty();
 }
 
 void KQOAuthRequest::setEnableDebugOutput(bool enabled) {
@@ -554,19 +924,18 @@ void KQOAuthRequest::setEnableDebugOutput(bool enabled) {
 /**
  * Protected implementations for inherited classes
  */
+void KQOAuthRequest::setFixedProtocolLayout() {
+    Q_D(KQOAuthRequest);
+
+    d->fixedProtocolLayout = true;
+    d->setDirty();
+}
+
 bool KQOAuthRequest::validateXAuthRequest() const {
     Q_D(const KQOAuthRequest);
 
-    if (d->oauthRequestEndpoint.isEmpty()
-        || d->oauthConsumerKey.isEmpty()
-        || d->oauthNonce_.isEmpty()
-        || d->oauthSignatureMethod.isEmpty()
-        || d->oauthTimestamp_.isEmpty()
-        || d->oauthVersion.isEmpty())
-    {
-        return false;
-    }
-    return true;
+    const int requiredFields = KQOAuthRequestPrivate::XAuthFields;
+    return (d->presentFields() & requiredFields) == requiredFields;
 }
 
 
@@ -583,6 +952,11 @@ QString KQOAuthRequest::consumerKeySecretForManager() const {
     return d->oauthConsumerSecretKey;
 }
 
+QString KQOAuthRequest::tokenSecretForManager() const {
+    Q_D(const KQOAuthRequest);
+    return d->oauthTokenSecret;
+}
+
 KQOAuthRequest::RequestSignatureMethod KQOAuthRequest::requestSignatureMethodForManager() const {
     Q_D(const KQOAuthRequest);
     return d->requestSignatureMethod;
@@ -593,17 +967,114 @@ QUrl KQOAuthRequest::callbackUrlForManager() const {
     return d->oauthCallbackUrl;
 }
 
+bool KQOAuthRequest::hasSigningContextForManager() const {
+    Q_D(const KQOAuthRequest);
+    return !d->signingContext.isNull()
+            && d->signingContext->matches(d->oauthConsumerSecretKey, d->oauthTokenSecret);
+}
+
+void KQOAuthRequest::setSigningContextForManager(const QSharedPointer<const KQOAuthSigningContext> &context) {
+    Q_D(KQOAuthRequest);
+    d->signingContext = context;
+}
+
+void KQOAuthRequest::setInternTableForManager(const QSharedPointer<KQOAuthInternTable> &table) {
+    Q_D(KQOAuthRequest);
+    d->internTable = table;
+}
+
+QByteArray KQOAuthRequest::signatureBaseStringForManager() {
+    Q_D(KQOAuthRequest);
+    d->prepareRequest();
+    return d->requestBaseString();
+}
+
+// The same bytes as the body, with the template's fixed parameters first.
+QByteArray KQOAuthRequest::queryForManager() const {
+    Q_D(const KQOAuthRequest);
+    return d->formParameters().form();
+}
+
+void KQOAuthRequest::setRsaSignatureForManager(const QByteArray &baseString, const QByteArray &signature) {
+    Q_D(KQOAuthRequest);
+    d->presignedBaseString = baseString;
+    d->presignedSignature = signature;
+    // The signature is only used by a header that is not signed yet.
+    d->signedParameters.clear();
+    d->signedHeader.clear();
+}
+
+// The fields are shared with the request data, not copied.
+void KQOAuthRequest::setRequestDataForManager(const KQOAuthRequestData &requestData) {
+    Q_D(KQOAuthRequest);
+    const KQOAuthRequestDataPrivate *data = requestData.d.constData();
+
+    initRequest(KQOAuthRequest::RequestType(data->requestType), data->endpoint);
+    setHttpMethod(KQOAuthRequest::RequestHttpMethod(data->httpMethod));
+    if (!data->credentials.isEmpty()) {
+        d->setCredentials(data->credentials);
+    }
+    if (data->signatureMethod != d->requestSignatureMethod) {
+        setSignatureMethod(KQOAuthRequest::RequestSignatureMethod(data->signatureMethod));
+    }
+
+    // Fields set on the request data override its credentials.
+    if (!data->consumerKey.isEmpty()) {
+        d->oauthConsumerKey = data->consumerKey;
+    }
+    if (!data->consumerSecretKey.isEmpty()) {
+        d->oauthConsumerSecretKey = data->consumerSecretKey;
+    }
+    if (!data->token.isEmpty()) {
+        d->oauthToken = data->token;
+    }
+    if (!data->tokenSecret.isEmpty()) {
+        d->oauthTokenSecret = data->tokenSecret;
+    }
+    d->oauthVerifier = data->verifier;
+    if (!data->callbackUrl.isEmpty()) {
+        d->oauthCallbackUrl = QUrl(data->callbackUrl);
+    }
+    d->additionalParameters = data->additionalParameters;
+    d->formParametersDirty = true;
+    if (!data->contentType.isEmpty()) {
+        d->contentType = data->contentType;
+    }
+    d->postRawData = data->rawData;
+    d->timeout = data->timeout;
+    d->setDirty();
+}
+
+// Makes a finished request as good as new for the request pool of KQOAuthManager. The timer,
+// the signing context and the buffers of the parameter lists are kept.
+void KQOAuthRequest::resetForManager() {
+    Q_D(KQOAuthRequest);
+
+    requestTimerStop();
+    clearRequest();
+    d->contentType.clear();
+    d->postRawData.clear();
+    d->presignedBaseString.clear();
+    d->presignedSignature.clear();
+    d->debugOutput = false;
+}
+
 void KQOAuthRequest::requestTimerStart()
 {
     Q_D(KQOAuthRequest);
     if (d->timeout > 0) {
-        d->timer.start(d->timeout);
+        // Most requests never time out, so the timer is only made when it is needed.
+        if (d->timer == 0) {
+            d->timer = new QTimer(this);
+            connect(d->timer, SIGNAL(timeout()), this, SIGNAL(requestTimedout()));
+        }
+        d->timer->start(d->timeout);
     }
 }
 
 void KQOAuthRequest::requestTimerStop()
 {
     Q_D(KQOAuthRequest);
-    if( d->timer.isActive() )
-        d->timer.stop();
+    if( d->timer != 0 && d->timer->isActive() )
+        d->timer->stop();
 }
@@ -23,12 +23,21 @@
 #include <QObject>
 #include <QUrl>
 #include <QMultiMap>
+#include <QSharedPointer>
 
 #include "kqoauthglobals.h"
 
 typedef QMultiMap<QString, QString> KQOAuthParameters;
 
+class QIODevice;
 class KQOAuthRequestPrivate;
+class KQOAuthSigningContext;
+class KQOAuthInternTable;
+class KQOAuthEndpoint;
+class KQOAuthRequestTemplate;
+class KQOAuthRequestData;
+class KQOAuthCredentials;
+class KQOAuthParameterList;
 class KQOAUTH_EXPORT KQOAuthRequest : public QObject
 {
     Q_OBJECT
@@ -69,6 +78,17 @@ public:
      */
     // Initialize the request of this type.
     void initRequest(KQOAuthRequest::RequestType type, const QUrl &requestEndpoint);
+    // Same as above with an endpoint that is already parsed and encoded. Prefer this when
+    // many requests go to the same endpoint.
+    void initRequest(KQOAuthRequest::RequestType type, const KQOAuthEndpoint &requestEndpoint);
+    // Initialize an authorized request from a template. Only the consumer secret and token
+    // secret, and the parameters that change, need to be set after this.
+    void initRequest(const KQOAuthRequestTemplate &requestTemplate);
+
+    // Sets the consumer key and secret, the token and token secret and the signature method at
+    // once, sharing the strings and the prepared signing state of 'credentials'.
+    void setCredentials(const KQOAuthCredentials &credentials);
+    KQOAuthCredentials credentials() const;
 
     void setConsumerKey(const QString &consumerKey);
     void setConsumerSecretKey(const QString &consumerSecretKey);
@@ -99,10 +119,13 @@ public:
     KQOAuthParameters additionalParameters() const;
     QList<QByteArray> requestParameters();  // This will return all request's parameters in the raw format given
                                             // to the QNetworkRequest.
+    QByteArray authorizationHeader();       // The complete "OAuth ..." value of the Authorization header,
+                                            // the parameters above joined in one buffer.
     QByteArray requestBody() const;         // This will return the POST body as given to the QNetworkRequest.
 
     KQOAuthRequest::RequestType requestType() const;
     QUrl requestEndpoint() const;
+    KQOAuthEndpoint endpoint() const;
 
     void setContentType(const QString &contentType);
     QString contentType();
@@ -110,6 +133,16 @@ public:
     void setRawData(const QByteArray &rawData);
     QByteArray rawData();
 
+    // Streams the raw body from 'device' instead. The device is not owned and has to stay open
+    // until the request is sent. It is read from its current position to the end.
+    void setRawData(QIODevice *device);
+    QIODevice *rawDataDevice() const;
+
+    // Sign the raw body with an oauth_body_hash parameter. A body given as a device is hashed
+    // in chunks and never held in memory. Not used for form encoded bodies.
+    void setBodyHashEnabled(bool enabled);
+    bool isBodyHashEnabled() const;
+
     void clearRequest();
 
     // Enable verbose debug output for request content.
@@ -122,6 +155,8 @@ Q_SIGNALS:
 
 protected:
     bool validateXAuthRequest() const;
+    // Keeps the protocol parameters in fixed slots, see KQOAuthRequest_1.
+    void setFixedProtocolLayout();
 
 private:
     KQOAuthRequestPrivate * const d_ptr;
@@ -132,14 +167,24 @@ private:
     // work with the opaque request.
     QString consumerKeyForManager() const;
     QString consumerKeySecretForManager() const;
+    QString tokenSecretForManager() const;
     KQOAuthRequest::RequestSignatureMethod requestSignatureMethodForManager() const;
     QUrl callbackUrlForManager() const;
+    bool hasSigningContextForManager() const;
+    void setSigningContextForManager(const QSharedPointer<const KQOAuthSigningContext> &context);
+    void setInternTableForManager(const QSharedPointer<KQOAuthInternTable> &table);
+    QByteArray signatureBaseStringForManager();
+    void setRsaSignatureForManager(const QByteArray &baseString, const QByteArray &signature);
+    QByteArray queryForManager() const;
+    void setRequestDataForManager(const KQOAuthRequestData &requestData);
+    void resetForManager();
 
     // This method is for timeout handling by the KQOAuthManager.
     void requestTimerStart();
     void requestTimerStop();
 
     friend class KQOAuthManager;
+    friend class KQOAuthManagerPrivate;
 #ifdef UNIT_TEST
     friend class Ut_KQOAuth;
 #endif
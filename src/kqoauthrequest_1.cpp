@@ -20,6 +20,8 @@
 
 #include "kqoauthrequest_1.h"
 
-KQOAuthRequest_1::KQOAuthRequest_1()
+KQOAuthRequest_1::KQOAuthRequest_1(QObject *parent) :
+        KQOAuthRequest(parent)
 {
+    setFixedProtocolLayout();
 }
@@ -23,10 +23,17 @@
 
 #include "kqoauthrequest.h"
 
+/**
+ * An OAuth 1.0a request with the protocol parameters in fixed slots, in the order they are
+ * signed in. The slots are laid out once for the request type and only their values are
+ * written when the request is signed again, so only the additional parameters are sorted and
+ * merged in. It is used the same way as KQOAuthRequest.
+ */
 class KQOAUTH_EXPORT KQOAuthRequest_1 : public KQOAuthRequest
 {
+    Q_OBJECT
 public:
-    KQOAuthRequest_1();
+    explicit KQOAuthRequest_1(QObject *parent = 0);
 };
 
 #endif // KQOAUTHREQUEST_1_H
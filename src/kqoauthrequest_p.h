@@ -21,6 +21,11 @@
 #define KQOAUTHREQUEST_P_H
 #include "kqoauthglobals.h"
 #include "kqoauthrequest.h"
+#include "kqoauthendpoint.h"
+#include "kqoauthrequesttemplate.h"
+#include "kqoauthcredentials.h"
+#include "kqoauthparameterlist_p.h"
+#include "kqoauthsigner_p.h"
 
 #include <QString>
 #include <QUrl>
@@ -28,6 +33,13 @@
 #include <QPair>
 #include <QMultiMap>
 #include <QTimer>
+#include <QSharedPointer>
+
+class QIODevice;
+class KQOAuthSigningContext;
+class KQOAuthRsaKey;
+class KQOAuthArena;
+class KQOAuthInternTable;
 
 class KQOAUTH_EXPORT KQOAuthRequestPrivate {
 
@@ -38,26 +50,86 @@ public:
     // Helper methods to get the values for the OAuth request parameters.
     QString oauthTimestamp() const;
     QString oauthNonce() const;
+    QString oauthBodyHash() const;
+    void clearDeviceBodyHash();
     QString oauthSignature();
+    void appendOauthSignature(KQOAuthArena &arena, QByteArray &out);
+
+    // The fields validateRequest() checks, as bits of presentFields().
+    enum RequestField {
+        EndpointField        = 0x001,
+        ConsumerKeyField     = 0x002,
+        NonceField           = 0x004,
+        SignatureMethodField = 0x008,
+        TimestampField       = 0x010,
+        VersionField         = 0x020,
+        TokenField           = 0x040,
+        TokenSecretField     = 0x080,
+        VerifierField        = 0x100
+    };
+
+    enum {
+        XAuthFields = EndpointField | ConsumerKeyField | NonceField
+                      | SignatureMethodField | TimestampField | VersionField,
+        TemporaryCredentialsFields = XAuthFields,
+        AccessTokenFields = XAuthFields | TokenField | TokenSecretField | VerifierField,
+        AuthorizedRequestFields = XAuthFields | TokenField | TokenSecretField
+    };
+
+    // The protocol parameters, in normalized order.
+    enum ProtocolKey {
+        BodyHashKey = 0,
+        CallbackKey,
+        ConsumerKeyKey,
+        NonceKey,
+        SignatureMethodKey,
+        TimestampKey,
+        TokenKey,
+        VerifierKey,
+        VersionKey,
+        ProtocolKeyCount
+    };
+
+    static const QString &protocolKey(ProtocolKey key);
+    QString protocolValue(ProtocolKey key) const;
+    // requestParameters holds protocolSlotCount() protocol parameters, in the order of
+    // protocolSlotKey().
+    int protocolSlotCount() const;
+    ProtocolKey protocolSlotKey(int slot) const;
 
     // Utility methods for making the request happen.
     void prepareRequest();
-    void signRequest();
+    void prepareProtocolSlots();
     bool validateRequest() const;
+    int presentFields() const;
+    void setDirty();
     QByteArray requestBaseString();
-    QByteArray encodedParamaterList(const QList< QPair<QString, QString> > &requestParameters);
+    const char *requestBaseString(KQOAuthArena &arena, int *length);
+    bool usesRequestTemplate() const;
+    const KQOAuthParameterList &fixedParameters() const;
+    const KQOAuthEncodedParameters &formParameters() const;
+    bool usesCredentials() const;
+    const KQOAuthEncodedParameters &encodedProtocolParameters() const;
+    KQOAuthParameterList changingProtocolParameters() const;
+    void setCredentials(const KQOAuthCredentials &requestCredentials);
+    void setSignatureMethod(KQOAuthRequest::RequestSignatureMethod method);
+    const QString &signatureMethodString() const;
+    // The Authorization header fragment of the parameter in requestParameters slot 'slot'.
+    QByteArray headerParameter(KQOAuthArena &arena, int slot) const;
+    const char *headerFragment(KQOAuthArena &arena, int slot, int *length) const;
+    const QByteArray *credentialsHeaderParameter(int slot) const;
     void insertAdditionalParams();
     void insertPostBody();
 
-    QUrl oauthRequestEndpoint;
+    KQOAuthEndpoint oauthRequestEndpoint;
     KQOAuthRequest::RequestHttpMethod oauthHttpMethod;
-    QString oauthHttpMethodString;
     QString oauthConsumerKey;
     QString oauthConsumerSecretKey;
     QString oauthToken;
     QString oauthTokenSecret;
-    QString oauthSignatureMethod;
     KQOAuthRequest::RequestSignatureMethod requestSignatureMethod;
+    // Signs with 'requestSignatureMethod', picked when the method is set. 0 if it is not set.
+    KQOAuthSigner::SignFunction signer;
     QUrl oauthCallbackUrl;
     QString oauthVersion;
     QString oauthVerifier;
@@ -66,15 +138,46 @@ public:
     QString oauthTimestamp_;
     QString oauthNonce_;
 
+    // The template the request was made with, if any. Its fixed parameters are sent before the
+    // additional ones.
+    KQOAuthRequestTemplate requestTemplate;
+
+    // The shared credentials given with setCredentials(), if any.
+    KQOAuthCredentials credentials;
+
     // User specified additional parameters needed for the request.
-    QList< QPair<QString, QString> > additionalParameters;
+    KQOAuthParameterList additionalParameters;
+
+    // The fixed and the additional parameters, encoded once for the base string, the form body
+    // and the URL query. Encoded again only after formParametersDirty is set, when they change.
+    mutable KQOAuthEncodedParameters encodedFormParameters;
+    mutable bool formParametersDirty;
+    mutable int formParametersEncodings;
+    // Encoded keys and values shared by KQOAuthManager, if it interns them.
+    QSharedPointer<KQOAuthInternTable> internTable;
 
      // The raw POST body content as given to the HTTP request.
      QByteArray postBodyContent;
 
     // Protocol parameters.
     // These parameters are used in the "Authorized" header of the HTTP request.
-    QList< QPair<QString, QString> > requestParameters;
+    KQOAuthParameterList requestParameters;
+
+    // Set by KQOAuthRequest_1. requestParameters then keeps its keys from one signature to the
+    // next, laid out for 'protocolLayout', and only the values are written again.
+    bool fixedProtocolLayout;
+    int protocolLayout;
+    bool protocolParametersDirty;
+
+    // The signed Authorization header fragments returned by requestParameters(). Kept until
+    // setDirty() is called by a setter.
+    QList<QByteArray> signedParameters;
+    // The same for authorizationHeader().
+    QByteArray signedHeader;
+
+    // The fields that are set, as RequestField bits. Computed again only after setDirty().
+    mutable int fields;
+    mutable bool fieldsDirty;
 
     KQOAuthRequest::RequestType requestType;
 
@@ -83,12 +186,33 @@ public:
 
     //Raw data to post if type is not url-encoded
     QByteArray postRawData;
+    // Or the device it is streamed from. Not owned.
+    QIODevice *postRawDevice;
+    // The body hash of 'hashedDevice', kept until the raw data is set again.
+    mutable QIODevice *hashedDevice;
+    mutable QString deviceBodyHash;
+
+    // Whether oauth_body_hash is sent, and its value once prepareRequest() has computed it.
+    bool bodyHashEnabled;
+    QString oauthBodyHash_;
 
     // Timeout for this request in milliseconds.
     int timeout;
-    QTimer timer;
+    // Created by requestTimerStart() when there is a timeout. Owned by the request.
+    QTimer *timer;
 
     bool debugOutput;
 
+    // Precomputed HMAC-SHA1 key state. Given by KQOAuthManager or created on first signature.
+    QSharedPointer<const KQOAuthSigningContext> signingContext;
+
+    // Parsed RSA private key, used when signing with RSA-SHA1.
+    QSharedPointer<KQOAuthRsaKey> rsaKey;
+
+    // RSA-SHA1 signature computed off the calling thread by KQOAuthManager, and the base
+    // string it was computed from. Used once, as long as the base string has not changed.
+    QByteArray presignedBaseString;
+    QByteArray presignedSignature;
+
 };
 #endif // KQOAUTHREQUEST_P_H
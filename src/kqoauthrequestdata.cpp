@@ -0,0 +1,185 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtGlobal>
+
+#include "kqoauthrequestdata.h"
+#include "kqoauthrequestdata_p.h"
+
+KQOAuthRequestDataPrivate::KQOAuthRequestDataPrivate() :
+    requestType(KQOAuthRequest::AuthorizedRequest),
+    httpMethod(KQOAuthRequest::POST),
+    signatureMethod(KQOAuthRequest::HMAC_SHA1),
+    timeout(0)
+{
+}
+
+// Empty requests share one private until they are changed.
+struct KQOAuthEmptyRequestData
+{
+    KQOAuthEmptyRequestData() : d(new KQOAuthRequestDataPrivate) {}
+    QSharedDataPointer<KQOAuthRequestDataPrivate> d;
+};
+Q_GLOBAL_STATIC(KQOAuthEmptyRequestData, emptyRequestData)
+
+KQOAuthRequestData::KQOAuthRequestData() :
+    d(emptyRequestData()->d)
+{
+}
+
+KQOAuthRequestData::KQOAuthRequestData(KQOAuthRequest::RequestType type, const KQOAuthEndpoint &endpoint) :
+    d(new KQOAuthRequestDataPrivate)
+{
+    d->requestType = type;
+    d->endpoint = endpoint;
+}
+
+KQOAuthRequestData::KQOAuthRequestData(const KQOAuthRequestData &other) :
+    d(other.d)
+{
+}
+
+KQOAuthRequestData &KQOAuthRequestData::operator=(const KQOAuthRequestData &other) {
+    d = other.d;
+    return *this;
+}
+
+KQOAuthRequestData::~KQOAuthRequestData()
+{
+}
+
+KQOAuthRequest::RequestType KQOAuthRequestData::requestType() const {
+    return KQOAuthRequest::RequestType(d->requestType);
+}
+
+KQOAuthEndpoint KQOAuthRequestData::endpoint() const {
+    return d->endpoint;
+}
+
+void KQOAuthRequestData::setHttpMethod(KQOAuthRequest::RequestHttpMethod httpMethod) {
+    d->httpMethod = httpMethod;
+}
+
+KQOAuthRequest::RequestHttpMethod KQOAuthRequestData::httpMethod() const {
+    return KQOAuthRequest::RequestHttpMethod(d->httpMethod);
+}
+
+void KQOAuthRequestData::setSignatureMethod(KQOAuthRequest::RequestSignatureMethod signatureMethod) {
+    d->signatureMethod = signatureMethod;
+}
+
+KQOAuthRequest::RequestSignatureMethod KQOAuthRequestData::signatureMethod() const {
+    return KQOAuthRequest::RequestSignatureMethod(d->signatureMethod);
+}
+
+void KQOAuthRequestData::setCredentials(const KQOAuthCredentials &credentials) {
+    d->credentials = credentials;
+    d->signatureMethod = credentials.signatureMethod();
+}
+
+KQOAuthCredentials KQOAuthRequestData::credentials() const {
+    return d->credentials;
+}
+
+void KQOAuthRequestData::setConsumerKey(const QString &consumerKey) {
+    d->consumerKey = consumerKey;
+}
+
+QString KQOAuthRequestData::consumerKey() const {
+    return d->consumerKey.isEmpty() ? d->credentials.consumerKey() : d->consumerKey;
+}
+
+void KQOAuthRequestData::setConsumerSecretKey(const QString &consumerSecretKey) {
+    d->consumerSecretKey = consumerSecretKey;
+}
+
+QString KQOAuthRequestData::consumerSecretKey() const {
+    return d->consumerSecretKey.isEmpty() ? d->credentials.consumerSecretKey() : d->consumerSecretKey;
+}
+
+void KQOAuthRequestData::setToken(const QString &token) {
+    d->token = token;
+}
+
+QString KQOAuthRequestData::token() const {
+    return d->token.isEmpty() ? d->credentials.token() : d->token;
+}
+
+void KQOAuthRequestData::setTokenSecret(const QString &tokenSecret) {
+    d->tokenSecret = tokenSecret;
+}
+
+QString KQOAuthRequestData::tokenSecret() const {
+    return d->tokenSecret.isEmpty() ? d->credentials.tokenSecret() : d->tokenSecret;
+}
+
+void KQOAuthRequestData::setVerifier(const QString &verifier) {
+    d->verifier = verifier;
+}
+
+QString KQOAuthRequestData::verifier() const {
+    return d->verifier;
+}
+
+void KQOAuthRequestData::setCallbackUrl(const QUrl &callbackUrl) {
+    d->callbackUrl = callbackUrl.toString();
+}
+
+QUrl KQOAuthRequestData::callbackUrl() const {
+    return QUrl(d->callbackUrl);
+}
+
+void KQOAuthRequestData::setAdditionalParameters(const KQOAuthParameters &additionalParams) {
+    d->additionalParameters.append(additionalParams);
+}
+
+void KQOAuthRequestData::addAdditionalParameter(const QString &key, const QString &value) {
+    d->additionalParameters.append(qMakePair(key, value));
+}
+
+KQOAuthParameters KQOAuthRequestData::additionalParameters() const {
+    return d->additionalParameters.toMap();
+}
+
+void KQOAuthRequestData::setContentType(const QString &contentType) {
+    d->contentType = contentType;
+}
+
+QString KQOAuthRequestData::contentType() const {
+    if (d->contentType.isEmpty()) {
+        return QString("application/x-www-form-urlencoded");
+    }
+    return d->contentType;
+}
+
+void KQOAuthRequestData::setRawData(const QByteArray &rawData) {
+    d->rawData = rawData;
+}
+
+QByteArray KQOAuthRequestData::rawData() const {
+    return d->rawData;
+}
+
+void KQOAuthRequestData::setTimeout(int timeoutMilliseconds) {
+    d->timeout = timeoutMilliseconds;
+}
+
+int KQOAuthRequestData::timeout() const {
+    return d->timeout;
+}
@@ -0,0 +1,101 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KQOAUTHREQUESTDATA_H
+#define KQOAUTHREQUESTDATA_H
+
+#include <QString>
+#include <QUrl>
+#include <QByteArray>
+#include <QSharedDataPointer>
+
+#include "kqoauthglobals.h"
+#include "kqoauthrequest.h"
+#include "kqoauthendpoint.h"
+#include "kqoauthcredentials.h"
+
+class KQOAuthRequestDataPrivate;
+
+/**
+ * Describes an OAuth request as a plain value: no QObject, no timer and one shared allocation
+ * for all of its fields. Copies are cheap and share the data until one of them is changed, so
+ * large numbers of queued requests can be kept in containers.
+ * Give it to KQOAuthManager::executeRequest() or executeAuthorizedRequest(), which create the
+ * KQOAuthRequest only when it is sent. The nonce and timestamp are generated then as well.
+ */
+class KQOAUTH_EXPORT KQOAuthRequestData
+{
+public:
+    KQOAuthRequestData();
+    KQOAuthRequestData(KQOAuthRequest::RequestType type, const KQOAuthEndpoint &endpoint);
+    KQOAuthRequestData(const KQOAuthRequestData &other);
+    KQOAuthRequestData &operator=(const KQOAuthRequestData &other);
+    ~KQOAuthRequestData();
+
+    KQOAuthRequest::RequestType requestType() const;
+    KQOAuthEndpoint endpoint() const;
+
+    // POST by default.
+    void setHttpMethod(KQOAuthRequest::RequestHttpMethod httpMethod);
+    KQOAuthRequest::RequestHttpMethod httpMethod() const;
+
+    // HMAC_SHA1 by default.
+    void setSignatureMethod(KQOAuthRequest::RequestSignatureMethod signatureMethod);
+    KQOAuthRequest::RequestSignatureMethod signatureMethod() const;
+
+    // Shares the credentials and their prepared state instead of carrying copies of them.
+    // The fields below override the matching part of the credentials when they are set.
+    // This also sets the signature method of the credentials.
+    void setCredentials(const KQOAuthCredentials &credentials);
+    KQOAuthCredentials credentials() const;
+
+    void setConsumerKey(const QString &consumerKey);
+    QString consumerKey() const;
+    void setConsumerSecretKey(const QString &consumerSecretKey);
+    QString consumerSecretKey() const;
+    void setToken(const QString &token);
+    QString token() const;
+    void setTokenSecret(const QString &tokenSecret);
+    QString tokenSecret() const;
+    void setVerifier(const QString &verifier);
+    QString verifier() const;
+    void setCallbackUrl(const QUrl &callbackUrl);
+    QUrl callbackUrl() const;
+
+    void setAdditionalParameters(const KQOAuthParameters &additionalParams);
+    void addAdditionalParameter(const QString &key, const QString &value);
+    KQOAuthParameters additionalParameters() const;
+
+    // "application/x-www-form-urlencoded" by default.
+    void setContentType(const QString &contentType);
+    QString contentType() const;
+    void setRawData(const QByteArray &rawData);
+    QByteArray rawData() const;
+
+    // In milliseconds, 0 disables the timeout.
+    void setTimeout(int timeoutMilliseconds);
+    int timeout() const;
+
+private:
+    QSharedDataPointer<KQOAuthRequestDataPrivate> d;
+
+    friend class KQOAuthRequest;
+};
+
+#endif // KQOAUTHREQUESTDATA_H
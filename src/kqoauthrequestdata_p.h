@@ -0,0 +1,58 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHREQUESTDATA_P_H
+#define KQOAUTHREQUESTDATA_P_H
+
+#include <QSharedData>
+#include <QString>
+#include <QByteArray>
+
+#include "kqoauthrequest.h"
+#include "kqoauthendpoint.h"
+#include "kqoauthcredentials.h"
+#include "kqoauthparameterlist_p.h"
+
+// Kept small: the enums share one word, the callback is a string instead of a QUrl, and an
+// empty content type stands for the default one.
+class KQOAuthRequestDataPrivate : public QSharedData
+{
+public:
+    KQOAuthRequestDataPrivate();
+
+    quint8 requestType;
+    quint8 httpMethod;
+    quint8 signatureMethod;
+    int timeout;
+
+    KQOAuthEndpoint endpoint;
+    KQOAuthCredentials credentials;
+    QString consumerKey;
+    QString consumerSecretKey;
+    QString token;
+    QString tokenSecret;
+    QString verifier;
+    QString callbackUrl;
+    QString contentType;
+    QByteArray rawData;
+    KQOAuthParameterList additionalParameters;
+};
+
+#endif // KQOAUTHREQUESTDATA_P_H
@@ -0,0 +1,111 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtGlobal>
+
+#include "kqoauthrequesttemplate.h"
+#include "kqoauthrequesttemplate_p.h"
+#include "kqoauthsigner_p.h"
+
+KQOAuthRequestTemplatePrivate::KQOAuthRequestTemplatePrivate() :
+    signatureMethod(KQOAuthRequest::HMAC_SHA1)
+{
+}
+
+// Empty templates share one private, so clearing a request does not allocate.
+struct KQOAuthEmptyRequestTemplate
+{
+    KQOAuthEmptyRequestTemplate() : d(new KQOAuthRequestTemplatePrivate) {}
+    QSharedDataPointer<KQOAuthRequestTemplatePrivate> d;
+};
+Q_GLOBAL_STATIC(KQOAuthEmptyRequestTemplate, emptyRequestTemplate)
+
+KQOAuthRequestTemplate::KQOAuthRequestTemplate() :
+    d(emptyRequestTemplate()->d)
+{
+}
+
+KQOAuthRequestTemplate::KQOAuthRequestTemplate(const KQOAuthEndpoint &endpoint,
+                                               const QString &consumerKey,
+                                               const QString &token,
+                                               const KQOAuthParameters &fixedParameters,
+                                               KQOAuthRequest::RequestSignatureMethod signatureMethod) :
+    d(new KQOAuthRequestTemplatePrivate)
+{
+    d->endpoint = endpoint;
+    d->consumerKey = consumerKey;
+    d->token = token;
+    d->signatureMethod = signatureMethod;
+    d->version = "1.0";
+
+    d->signatureMethodString = KQOAuthSigner::methodName(signatureMethod);
+    if (d->signatureMethodString.isEmpty()) {
+        qWarning("Invalid signature method set.");
+    }
+
+    d->fixedParameters.append(fixedParameters);
+    d->encodedFixedParameters = KQOAuthEncodedParameters(d->fixedParameters);
+    KQOAuthParameterList parameters;
+    parameters.append(qMakePair(QString(OAUTH_KEY_CONSUMER_KEY), consumerKey));
+    parameters.append(qMakePair(QString(OAUTH_KEY_SIGNATURE_METHOD), d->signatureMethodString));
+    parameters.append(qMakePair(QString(OAUTH_KEY_TOKEN), token));
+    parameters.append(qMakePair(QString(OAUTH_KEY_VERSION), d->version));
+    d->encodedParameters = KQOAuthEncodedParameters(parameters);
+}
+
+KQOAuthRequestTemplate::KQOAuthRequestTemplate(const KQOAuthRequestTemplate &other) :
+    d(other.d)
+{
+}
+
+KQOAuthRequestTemplate &KQOAuthRequestTemplate::operator=(const KQOAuthRequestTemplate &other) {
+    d = other.d;
+    return *this;
+}
+
+KQOAuthRequestTemplate::~KQOAuthRequestTemplate()
+{
+}
+
+bool KQOAuthRequestTemplate::isValid() const {
+    return d->endpoint.isValid()
+            && !d->consumerKey.isEmpty()
+            && !d->token.isEmpty()
+            && !d->signatureMethodString.isEmpty();
+}
+
+KQOAuthEndpoint KQOAuthRequestTemplate::endpoint() const {
+    return d->endpoint;
+}
+
+QString KQOAuthRequestTemplate::consumerKey() const {
+    return d->consumerKey;
+}
+
+QString KQOAuthRequestTemplate::token() const {
+    return d->token;
+}
+
+KQOAuthParameters KQOAuthRequestTemplate::fixedParameters() const {
+    return d->fixedParameters.toMap();
+}
+
+KQOAuthRequest::RequestSignatureMethod KQOAuthRequestTemplate::signatureMethod() const {
+    return d->signatureMethod;
+}
@@ -0,0 +1,67 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KQOAUTHREQUESTTEMPLATE_H
+#define KQOAUTHREQUESTTEMPLATE_H
+
+#include <QString>
+#include <QSharedDataPointer>
+
+#include "kqoauthglobals.h"
+#include "kqoauthrequest.h"
+#include "kqoauthendpoint.h"
+
+class KQOAuthRequestTemplatePrivate;
+
+/**
+ * The parts of an authorized request that stay the same from one request to the next: the
+ * endpoint, the consumer key, the token, the signature method and any fixed parameters.
+ * These parameters are sorted and percent encoded once, when the template is created. A request
+ * made with KQOAuthRequest::initRequest(const KQOAuthRequestTemplate &) then only encodes its
+ * nonce, timestamp and additional parameters, and merges them into the stored ones.
+ * Copies are cheap and share the same data.
+ */
+class KQOAUTH_EXPORT KQOAuthRequestTemplate
+{
+public:
+    KQOAuthRequestTemplate();
+    KQOAuthRequestTemplate(const KQOAuthEndpoint &endpoint,
+                           const QString &consumerKey,
+                           const QString &token,
+                           const KQOAuthParameters &fixedParameters = KQOAuthParameters(),
+                           KQOAuthRequest::RequestSignatureMethod signatureMethod = KQOAuthRequest::HMAC_SHA1);
+    KQOAuthRequestTemplate(const KQOAuthRequestTemplate &other);
+    KQOAuthRequestTemplate &operator=(const KQOAuthRequestTemplate &other);
+    ~KQOAuthRequestTemplate();
+
+    bool isValid() const;
+
+    KQOAuthEndpoint endpoint() const;
+    QString consumerKey() const;
+    QString token() const;
+    KQOAuthParameters fixedParameters() const;
+    KQOAuthRequest::RequestSignatureMethod signatureMethod() const;
+
+private:
+    QSharedDataPointer<KQOAuthRequestTemplatePrivate> d;
+
+    friend class KQOAuthRequestPrivate;
+};
+
+#endif // KQOAUTHREQUESTTEMPLATE_H
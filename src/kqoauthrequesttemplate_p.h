@@ -0,0 +1,52 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHREQUESTTEMPLATE_P_H
+#define KQOAUTHREQUESTTEMPLATE_P_H
+
+#include <QSharedData>
+#include <QString>
+
+#include "kqoauthrequest.h"
+#include "kqoauthendpoint.h"
+#include "kqoauthbasestring_p.h"
+#include "kqoauthparameterlist_p.h"
+
+class KQOAuthRequestTemplatePrivate : public QSharedData
+{
+public:
+    KQOAuthRequestTemplatePrivate();
+
+    KQOAuthEndpoint endpoint;
+    QString consumerKey;
+    QString token;
+    KQOAuthRequest::RequestSignatureMethod signatureMethod;
+    QString signatureMethodString;
+    QString version;
+    KQOAuthParameterList fixedParameters;
+
+    // The oauth_consumer_key, oauth_signature_method, oauth_token and oauth_version protocol
+    // parameters.
+    KQOAuthEncodedParameters encodedParameters;
+    // The fixed parameters. Requests add their own parameters to them without encoding them again.
+    KQOAuthEncodedParameters encodedFixedParameters;
+};
+
+#endif // KQOAUTHREQUESTTEMPLATE_P_H
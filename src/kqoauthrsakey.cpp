@@ -0,0 +1,175 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <QtDebug>
+#include "kqoauthrsakey_p.h"
+
+#include <openssl/pem.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+// Parsed keys are few and long lived. The limit only protects against callers that
+// generate a new key for every request.
+static const int MaxCachedKeys = 64;
+static const int MaxFailedKeys = 64;
+
+// Keyed on the PEM itself, which QCache hashes far faster than a digest of it could be made.
+// QCache moves an entry it returns to the front and drops the least recently used one when
+// full. PEMs that do not parse have their own table, so they cannot push out a valid key.
+static QMutex rsaKeyCacheMutex;
+static QCache< QString, QSharedPointer<KQOAuthRsaKey> > rsaKeyCache(MaxCachedKeys);
+static QCache<QString, bool> failedPems(MaxFailedKeys);
+
+// Caches 'key' for 'pem' unless another thread got there first, and returns the cached one.
+// Keys dropped from the cache stay alive in the requests using them.
+static QSharedPointer<KQOAuthRsaKey> cacheKey(const QString &pem, const QSharedPointer<KQOAuthRsaKey> &key) {
+    QMutexLocker locker(&rsaKeyCacheMutex);
+    const QSharedPointer<KQOAuthRsaKey> *cached = rsaKeyCache.object(pem);
+    if (cached != 0) {
+        return *cached;
+    }
+
+    rsaKeyCache.insert(pem, new QSharedPointer<KQOAuthRsaKey>(key));
+    return key;
+}
+
+static QSharedPointer<KQOAuthRsaKey> cacheFailure(const QString &pem) {
+    QMutexLocker locker(&rsaKeyCacheMutex);
+    failedPems.insert(pem, new bool(true));
+    return QSharedPointer<KQOAuthRsaKey>();
+}
+
+static void warnOpenSslErrors(const char *message) {
+    qWarning() << message;
+
+    unsigned long error;
+    while ((error = ERR_get_error()) != 0) {
+        char errorString[256];
+        ERR_error_string_n(error, errorString, sizeof(errorString));
+        qWarning() << " *" << errorString;
+    }
+}
+
+void KQOAuthRsaKey::initializeOpenSsl() {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    // OpenSSL takes care of running this only once, and does it thread safely.
+    OPENSSL_init_ssl(OPENSSL_INIT_LOAD_SSL_STRINGS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS, 0);
+    OPENSSL_init_crypto(OPENSSL_INIT_ADD_ALL_CIPHERS | OPENSSL_INIT_ADD_ALL_DIGESTS, 0);
+#else
+    static QBasicAtomicInt initialized = Q_BASIC_ATOMIC_INITIALIZER(0);
+    static QMutex initMutex;
+
+    if (initialized.testAndSetAcquire(1, 1)) {
+        return;
+    }
+
+    QMutexLocker locker(&initMutex);
+    if (initialized.testAndSetAcquire(1, 1)) {
+        return;
+    }
+
+    SSL_load_error_strings();
+    OpenSSL_add_all_algorithms();
+    OpenSSL_add_all_ciphers();
+    OpenSSL_add_all_digests();
+    initialized.fetchAndStoreRelease(1);
+#endif
+}
+
+KQOAuthRsaKey::KQOAuthRsaKey(EVP_PKEY *key, const QString &pem) :
+    key(key),
+    pem(pem)
+{
+}
+
+KQOAuthRsaKey::~KQOAuthRsaKey() {
+    EVP_PKEY_free(key);
+}
+
+QSharedPointer<KQOAuthRsaKey> KQOAuthRsaKey::fromPem(const QString &pem) {
+    {
+        QMutexLocker locker(&rsaKeyCacheMutex);
+        const QSharedPointer<KQOAuthRsaKey> *cached = rsaKeyCache.object(pem);
+        if (cached != 0) {
+            return *cached;
+        }
+        if (failedPems.contains(pem)) {
+            return QSharedPointer<KQOAuthRsaKey>();
+        }
+    }
+
+    initializeOpenSsl();
+
+    QByteArray data = pem.toLocal8Bit();
+    BIO *bufio = BIO_new_mem_buf((void *) data.constData(), data.size());
+    EVP_PKEY *evpKey = 0;
+    if (bufio) {
+        evpKey = PEM_read_bio_PrivateKey(bufio, 0, 0, 0);
+        BIO_free(bufio);
+    }
+
+    if (evpKey == 0) {
+        warnOpenSslErrors("Can not parse RSA data. Errors:");
+        return cacheFailure(pem);
+    }
+
+    if (EVP_PKEY_base_id(evpKey) != EVP_PKEY_RSA) {
+        qWarning() << "The private key is not an RSA key.";
+        EVP_PKEY_free(evpKey);
+        return cacheFailure(pem);
+    }
+
+    return cacheKey(pem, QSharedPointer<KQOAuthRsaKey>(new KQOAuthRsaKey(evpKey, pem)));
+}
+
+bool KQOAuthRsaKey::matches(const QString &pem) const {
+    return this->pem == pem;
+}
+
+QByteArray KQOAuthRsaKey::sign(const QByteArray &message) const {
+    return sign(message.constData(), message.size());
+}
+
+QByteArray KQOAuthRsaKey::sign(const char *message, int length) const {
+    EVP_MD_CTX *ctx = EVP_MD_CTX_create();
+    if (ctx == 0) {
+        return QByteArray();
+    }
+
+    QByteArray signature(EVP_PKEY_size(key), Qt::Uninitialized);
+    unsigned int signatureLength = 0;
+
+    bool ok = EVP_SignInit_ex(ctx, EVP_sha1(), 0)
+              && EVP_SignUpdate(ctx, message, length)
+              && EVP_SignFinal(ctx, reinterpret_cast<unsigned char *>(signature.data()), &signatureLength, key);
+
+    EVP_MD_CTX_destroy(ctx);
+
+    if (!ok) {
+        warnOpenSslErrors("RSA-SHA1 signing failed. Errors:");
+        return QByteArray();
+    }
+
+    signature.resize(signatureLength);
+    return signature;
+}
@@ -0,0 +1,65 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHRSAKEY_P_H
+#define KQOAUTHRSAKEY_P_H
+
+#include <QString>
+#include <QByteArray>
+#include <QSharedPointer>
+
+#include "kqoauthglobals.h"
+
+#include <openssl/evp.h>
+
+/**
+ * A parsed RSA private key. The PEM is parsed only once and the key is then reused
+ * for every RSA-SHA1 signature. Keys are cached by their PEM, so all requests signing
+ * with the same key share one handle. The cache keeps the most recently used keys, and
+ * separately the PEMs that failed to parse.
+ * Signing does not modify the key, so a handle can be used from several threads.
+ */
+class KQOAUTH_EXPORT KQOAuthRsaKey
+{
+public:
+    ~KQOAuthRsaKey();
+
+    // Returns the cached key for the PEM, or a null pointer if the PEM cannot be parsed.
+    // Either result is cached, so a PEM is parsed only once.
+    static QSharedPointer<KQOAuthRsaKey> fromPem(const QString &pem);
+
+    bool matches(const QString &pem) const;
+
+    // Returns the raw RSA-SHA1 signature of the message, or an empty array on error.
+    QByteArray sign(const QByteArray &message) const;
+    QByteArray sign(const char *message, int length) const;
+
+    // OpenSSL global initialisation. Done lazily, only once, and safe to call from any thread.
+    static void initializeOpenSsl();
+
+private:
+    KQOAuthRsaKey(EVP_PKEY *key, const QString &pem);
+    Q_DISABLE_COPY(KQOAuthRsaKey);
+
+    EVP_PKEY *key;
+    QString pem;
+};
+
+#endif // KQOAUTHRSAKEY_P_H
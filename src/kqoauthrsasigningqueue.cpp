@@ -0,0 +1,110 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <limits.h>
+
+#include <QRunnable>
+#include <QMetaObject>
+
+#include "kqoauthrsasigningqueue_p.h"
+#include "kqoauthrsakey_p.h"
+
+class KQOAuthRsaSigningTask : public QRunnable
+{
+public:
+    KQOAuthRsaSigningTask(KQOAuthRsaSigningQueue *queue, int ticket,
+                          const QString &privateKey, const QByteArray &baseString) :
+        queue(queue),
+        ticket(ticket),
+        privateKey(privateKey),
+        baseString(baseString)
+    {
+    }
+
+    void run() {
+        // The key cache is thread safe, so the PEM is still parsed only once per key.
+        QByteArray signature;
+        QSharedPointer<KQOAuthRsaKey> key = KQOAuthRsaKey::fromPem(privateKey);
+        if (!key.isNull()) {
+            signature = key->sign(baseString);
+        }
+
+        // The queue waits for all tasks before it is destroyed, so it is still alive here.
+        QMetaObject::invokeMethod(queue, "onSigned", Qt::QueuedConnection,
+                                  Q_ARG(int, ticket), Q_ARG(QByteArray, signature));
+    }
+
+private:
+    KQOAuthRsaSigningQueue *queue;
+    int ticket;
+    QString privateKey;
+    QByteArray baseString;
+};
+
+KQOAuthRsaSigningQueue::KQOAuthRsaSigningQueue(QObject *parent) :
+    QObject(parent),
+    nextTicket(0),
+    pending(0),
+    maxPending(DefaultMaxPendingCount)
+{
+    pool.setMaxThreadCount(1);
+}
+
+KQOAuthRsaSigningQueue::~KQOAuthRsaSigningQueue()
+{
+    pool.waitForDone();
+}
+
+void KQOAuthRsaSigningQueue::setMaxThreadCount(int maxThreads) {
+    pool.setMaxThreadCount(qMax(1, maxThreads));
+}
+
+int KQOAuthRsaSigningQueue::maxThreadCount() const {
+    return pool.maxThreadCount();
+}
+
+int KQOAuthRsaSigningQueue::pendingCount() const {
+    return pending;
+}
+
+void KQOAuthRsaSigningQueue::setMaxPendingCount(int count) {
+    maxPending = qMax(1, count);
+}
+
+int KQOAuthRsaSigningQueue::maxPendingCount() const {
+    return maxPending;
+}
+
+int KQOAuthRsaSigningQueue::enqueue(const QString &privateKey, const QByteArray &baseString) {
+    if (pending >= maxPending) {
+        return -1;
+    }
+
+    // Tickets stay non-negative when the counter wraps.
+    const int ticket = nextTicket;
+    nextTicket = (nextTicket == INT_MAX) ? 0 : nextTicket + 1;
+    pending++;
+    pool.start(new KQOAuthRsaSigningTask(this, ticket, privateKey, baseString));
+    return ticket;
+}
+
+void KQOAuthRsaSigningQueue::onSigned(int ticket, QByteArray signature) {
+    pending--;
+    emit signatureReady(ticket, signature);
+}
@@ -0,0 +1,75 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHRSASIGNINGQUEUE_P_H
+#define KQOAUTHRSASIGNINGQUEUE_P_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QThreadPool>
+
+#include "kqoauthglobals.h"
+
+/**
+ * Computes RSA-SHA1 signatures on a bounded pool of worker threads, so that signing with
+ * large keys does not block the thread KQOAuthManager lives in. Every signature gets a
+ * ticket, and signatureReady() is emitted with that ticket in the thread of this object.
+ */
+class KQOAUTH_EXPORT KQOAuthRsaSigningQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit KQOAuthRsaSigningQueue(QObject *parent = 0);
+    // Waits for the signatures that are still being computed.
+    ~KQOAuthRsaSigningQueue();
+
+    void setMaxThreadCount(int maxThreads);
+    int maxThreadCount() const;
+
+    // The number of signatures queued or being computed.
+    int pendingCount() const;
+
+    // At most this many signatures are pending at once. The default is DefaultMaxPendingCount.
+    enum { DefaultMaxPendingCount = 256 };
+    void setMaxPendingCount(int count);
+    int maxPendingCount() const;
+
+    // Signs 'baseString' with the PEM encoded 'privateKey'. Returns the ticket of the signature,
+    // or -1 if maxPendingCount() signatures are pending already.
+    int enqueue(const QString &privateKey, const QByteArray &baseString);
+
+Q_SIGNALS:
+    // The signature is the raw RSA-SHA1 signature, or empty if the key could not be used.
+    void signatureReady(int ticket, QByteArray signature);
+
+private Q_SLOTS:
+    void onSigned(int ticket, QByteArray signature);
+
+private:
+    Q_DISABLE_COPY(KQOAuthRsaSigningQueue);
+
+    QThreadPool pool;
+    int nextTicket;
+    int pending;
+    int maxPending;
+};
+
+#endif // KQOAUTHRSASIGNINGQUEUE_P_H
@@ -0,0 +1,569 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include <QVarLengthArray>
+
+#include "kqoauthsha1_p.h"
+#include "kqoauthcpufeatures_p.h"
+
+#ifdef KQOAUTH_X86_DISPATCH
+#  include <immintrin.h>
+#endif
+
+/* http://tools.ietf.org/html/rfc3174 */
+
+static inline quint32 rol32(quint32 value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline quint32 readBigEndian32(const uchar *p) {
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+static inline void writeBigEndian32(uchar *p, quint32 value) {
+    p[0] = uchar(value >> 24);
+    p[1] = uchar(value >> 16);
+    p[2] = uchar(value >> 8);
+    p[3] = uchar(value);
+}
+
+KQOAuthSha1::KQOAuthSha1(Implementation implementation) :
+    used(implementation),
+    chain(initialState()),
+    length(0),
+    bufferLength(0)
+{
+}
+
+KQOAuthSha1::KQOAuthSha1(const State &midstate, quint64 processedBytes, Implementation implementation) :
+    used(implementation),
+    chain(midstate),
+    length(processedBytes),
+    bufferLength(0)
+{
+    Q_ASSERT(processedBytes % BlockSize == 0);
+}
+
+KQOAuthSha1::State KQOAuthSha1::initialState() {
+    State state;
+    state.h[0] = 0x67452301;
+    state.h[1] = 0xEFCDAB89;
+    state.h[2] = 0x98BADCFE;
+    state.h[3] = 0x10325476;
+    state.h[4] = 0xC3D2E1F0;
+    return state;
+}
+
+KQOAuthSha1::State KQOAuthSha1::state() const {
+    Q_ASSERT(bufferLength == 0);
+    return chain;
+}
+
+void KQOAuthSha1::addData(const char *data, int dataLength) {
+    const uchar *input = reinterpret_cast<const uchar *>(data);
+    length += dataLength;
+
+    // Fill up a partially filled block first.
+    if (bufferLength > 0) {
+        int count = qMin(dataLength, int(BlockSize) - bufferLength);
+        memcpy(buffer + bufferLength, input, count);
+        bufferLength += count;
+        input += count;
+        dataLength -= count;
+
+        if (bufferLength < BlockSize) {
+            return;
+        }
+        compress(chain, buffer, 1, used);
+        bufferLength = 0;
+    }
+
+    // Then compress the full blocks straight from the input.
+    int blocks = dataLength / BlockSize;
+    if (blocks > 0) {
+        compress(chain, input, blocks, used);
+        input += blocks * BlockSize;
+        dataLength -= blocks * BlockSize;
+    }
+
+    if (dataLength > 0) {
+        memcpy(buffer, input, dataLength);
+        bufferLength = dataLength;
+    }
+}
+
+void KQOAuthSha1::result(uchar *digest) {
+    const quint64 bitLength = length * 8;
+
+    // Append the '1' bit, zero padding and the message length in bits.
+    buffer[bufferLength++] = 0x80;
+    if (bufferLength > BlockSize - 8) {
+        memset(buffer + bufferLength, 0, BlockSize - bufferLength);
+        compress(chain, buffer, 1, used);
+        bufferLength = 0;
+    }
+    memset(buffer + bufferLength, 0, BlockSize - 8 - bufferLength);
+    writeBigEndian32(buffer + BlockSize - 8, quint32(bitLength >> 32));
+    writeBigEndian32(buffer + BlockSize - 4, quint32(bitLength));
+    compress(chain, buffer, 1, used);
+    bufferLength = 0;
+
+    for (int i = 0; i < 5; i++) {
+        writeBigEndian32(digest + i * 4, chain.h[i]);
+    }
+}
+
+static void compressScalar(KQOAuthSha1::State &state, const uchar *blocks, int blockCount) {
+    quint32 w[80];
+
+    for (int block = 0; block < blockCount; block++, blocks += KQOAuthSha1::BlockSize) {
+        for (int i = 0; i < 16; i++) {
+            w[i] = readBigEndian32(blocks + i * 4);
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = rol32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        quint32 a = state.h[0];
+        quint32 b = state.h[1];
+        quint32 c = state.h[2];
+        quint32 d = state.h[3];
+        quint32 e = state.h[4];
+
+#define KQOAUTH_SHA1_ROUND(f, k)                                \
+        {                                                       \
+            quint32 temp = rol32(a, 5) + (f) + e + (k) + w[i];  \
+            e = d;                                              \
+            d = c;                                              \
+            c = rol32(b, 30);                                   \
+            b = a;                                              \
+            a = temp;                                           \
+        }
+
+        int i = 0;
+        for (; i < 20; i++) KQOAUTH_SHA1_ROUND((b & c) | (~b & d), 0x5A827999)
+        for (; i < 40; i++) KQOAUTH_SHA1_ROUND(b ^ c ^ d, 0x6ED9EBA1)
+        for (; i < 60; i++) KQOAUTH_SHA1_ROUND((b & c) | (b & d) | (c & d), 0x8F1BBCDC)
+        for (; i < 80; i++) KQOAUTH_SHA1_ROUND(b ^ c ^ d, 0xCA62C1D6)
+#undef KQOAUTH_SHA1_ROUND
+
+        state.h[0] += a;
+        state.h[1] += b;
+        state.h[2] += c;
+        state.h[3] += d;
+        state.h[4] += e;
+    }
+}
+
+#ifdef KQOAUTH_X86_DISPATCH
+
+/**
+ * SHA-1 with the Intel SHA extensions. Four rounds per sha1rnds4 instruction, the
+ * message schedule is computed with sha1msg1/sha1msg2.
+ */
+__attribute__((target("sha,sse4.1,ssse3")))
+static void compressShaNi(KQOAuthSha1::State &state, const uchar *blocks, int blockCount) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(state.h)), 0x1B);
+    __m128i e0 = _mm_set_epi32(int(state.h[4]), 0, 0, 0);
+    __m128i e1;
+    __m128i msg[4];
+
+    for (int block = 0; block < blockCount; block++, blocks += KQOAuthSha1::BlockSize) {
+        const __m128i abcdSave = abcd;
+        const __m128i eSave = e0;
+
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + i * 16)), byteSwap);
+        }
+
+        // Every group does four rounds. From group 4 on, msg[g % 4] is replaced with the
+        // next four schedule words W[4g..4g+3] computed from the previous sixteen.
+        // 'e0' and 'e1' take turns holding the E value for the next group.
+#define KQOAUTH_SHA1NI_GROUP(g, eIn, eOut)                                                     \
+        if ((g) >= 4) {                                                                        \
+            msg[(g) % 4] = _mm_sha1msg2_epu32(                                                 \
+                        _mm_xor_si128(_mm_sha1msg1_epu32(msg[(g) % 4], msg[((g) + 1) % 4]),    \
+                                      msg[((g) + 2) % 4]),                                     \
+                        msg[((g) + 3) % 4]);                                                   \
+        }                                                                                      \
+        eIn = ((g) == 0) ? _mm_add_epi32(eIn, msg[0]) : _mm_sha1nexte_epu32(eIn, msg[(g) % 4]); \
+        eOut = abcd;                                                                           \
+        abcd = _mm_sha1rnds4_epu32(abcd, eIn, (g) / 5);
+
+        KQOAUTH_SHA1NI_GROUP(0, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(1, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(2, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(3, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(4, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(5, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(6, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(7, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(8, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(9, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(10, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(11, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(12, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(13, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(14, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(15, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(16, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(17, e1, e0)
+        KQOAUTH_SHA1NI_GROUP(18, e0, e1)
+        KQOAUTH_SHA1NI_GROUP(19, e1, e0)
+#undef KQOAUTH_SHA1NI_GROUP
+
+        // After the last group e0 holds the A of group 19, which is rotated into the new E.
+        e0 = _mm_sha1nexte_epu32(e0, eSave);
+        abcd = _mm_add_epi32(abcd, abcdSave);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state.h), _mm_shuffle_epi32(abcd, 0x1B));
+    state.h[4] = quint32(_mm_extract_epi32(e0, 3));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i rol32x8(__m256i value, int bits) {
+    return _mm256_or_si256(_mm256_slli_epi32(value, bits), _mm256_srli_epi32(value, 32 - bits));
+}
+
+/**
+ * Multi-buffer SHA-1: one block of eight independent messages at once, one message
+ * per 32 bit lane of the AVX2 registers.
+ */
+__attribute__((target("avx2")))
+static void compressAvx2x8(KQOAuthSha1::State * const *states, const uchar * const *blocks) {
+    const __m256i byteSwap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                             12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    __m256i w[16];
+    for (int i = 0; i < 16; i++) {
+        quint32 words[8];
+        for (int lane = 0; lane < 8; lane++) {
+            memcpy(&words[lane], blocks[lane] + i * 4, 4);
+        }
+        w[i] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(words)), byteSwap);
+    }
+
+    __m256i h[5];
+    for (int j = 0; j < 5; j++) {
+        quint32 words[8];
+        for (int lane = 0; lane < 8; lane++) {
+            words[lane] = states[lane]->h[j];
+        }
+        h[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words));
+    }
+
+    __m256i a = h[0];
+    __m256i b = h[1];
+    __m256i c = h[2];
+    __m256i d = h[3];
+    __m256i e = h[4];
+
+    for (int i = 0; i < 80; i++) {
+        __m256i wi;
+        if (i < 16) {
+            wi = w[i];
+        } else {
+            wi = rol32x8(_mm256_xor_si256(_mm256_xor_si256(w[(i - 3) & 15], w[(i - 8) & 15]),
+                                          _mm256_xor_si256(w[(i - 14) & 15], w[i & 15])), 1);
+            w[i & 15] = wi;
+        }
+
+        __m256i f;
+        __m256i k;
+        if (i < 20) {
+            f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_andnot_si256(b, d));
+            k = _mm256_set1_epi32(0x5A827999);
+        } else if (i < 40) {
+            f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+            k = _mm256_set1_epi32(0x6ED9EBA1);
+        } else if (i < 60) {
+            f = _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)));
+            k = _mm256_set1_epi32(int(0x8F1BBCDC));
+        } else {
+            f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+            k = _mm256_set1_epi32(int(0xCA62C1D6));
+        }
+
+        __m256i temp = _mm256_add_epi32(_mm256_add_epi32(rol32x8(a, 5), f),
+                                        _mm256_add_epi32(_mm256_add_epi32(e, k), wi));
+        e = d;
+        d = c;
+        c = rol32x8(b, 30);
+        b = a;
+        a = temp;
+    }
+
+    h[0] = _mm256_add_epi32(h[0], a);
+    h[1] = _mm256_add_epi32(h[1], b);
+    h[2] = _mm256_add_epi32(h[2], c);
+    h[3] = _mm256_add_epi32(h[3], d);
+    h[4] = _mm256_add_epi32(h[4], e);
+
+    for (int j = 0; j < 5; j++) {
+        quint32 words[8];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(words), h[j]);
+        for (int lane = 0; lane < 8; lane++) {
+            states[lane]->h[j] = words[lane];
+        }
+    }
+}
+
+#endif // KQOAUTH_X86_DISPATCH
+
+static KQOAuthSha1::Implementation detectImplementation() {
+#ifdef KQOAUTH_X86_DISPATCH
+    if (KQOAuthCpuFeatures::hasShaNi()) {
+        return KQOAuthSha1::ShaNiImplementation;
+    }
+    if (KQOAuthCpuFeatures::hasAvx2()) {
+        return KQOAuthSha1::Avx2Implementation;
+    }
+#endif
+    return KQOAuthSha1::ScalarImplementation;
+}
+
+static KQOAuthSha1::Implementation detectedImplementation() {
+    static const KQOAuthSha1::Implementation detected = detectImplementation();
+    return detected;
+}
+
+bool KQOAuthSha1::isSupported(KQOAuthSha1::Implementation implementation) {
+    switch (implementation) {
+    case AutomaticImplementation:
+    case ScalarImplementation:
+        return true;
+#ifdef KQOAUTH_X86_DISPATCH
+    case Avx2Implementation:
+        return KQOAuthCpuFeatures::hasAvx2();
+    case ShaNiImplementation:
+        return KQOAuthCpuFeatures::hasShaNi();
+#endif
+    default:
+        return false;
+    }
+}
+
+KQOAuthSha1::Implementation KQOAuthSha1::implementation() {
+    return detectedImplementation();
+}
+
+// Automatic, or one the CPU does not support, means the detected implementation.
+static KQOAuthSha1::Implementation resolve(KQOAuthSha1::Implementation implementation) {
+    if (implementation == KQOAuthSha1::AutomaticImplementation || !KQOAuthSha1::isSupported(implementation)) {
+        return detectedImplementation();
+    }
+    return implementation;
+}
+
+void KQOAuthSha1::compress(State &state, const uchar *blocks, int blockCount, Implementation implementation) {
+#ifdef KQOAUTH_X86_DISPATCH
+    if (resolve(implementation) == ShaNiImplementation) {
+        compressShaNi(state, blocks, blockCount);
+        return;
+    }
+#endif
+    compressScalar(state, blocks, blockCount);
+}
+
+void KQOAuthSha1::compressBatch(Job *jobs, int jobCount, Implementation implementation) {
+    implementation = resolve(implementation);
+#ifdef KQOAUTH_X86_DISPATCH
+    if (implementation == Avx2Implementation) {
+        // Eight lanes. A lane takes the next job as soon as its current one is done,
+        // so jobs of different lengths keep the lanes busy.
+        const int Lanes = 8;
+        int laneJob[Lanes];
+        int laneBlock[Lanes];
+        KQOAuthSha1::State *states[Lanes];
+        const uchar *blocks[Lanes];
+
+        // Idle lanes hash a dummy block into a dummy state.
+        KQOAuthSha1::State idleStates[Lanes];
+        static const uchar idleBlock[BlockSize] = { 0 };
+
+        int nextJob = 0;
+        int active = 0;
+        for (int lane = 0; lane < Lanes; lane++) {
+            laneJob[lane] = -1;
+        }
+
+        for (;;) {
+            for (int lane = 0; lane < Lanes; lane++) {
+                if (laneJob[lane] >= 0) {
+                    continue;
+                }
+                while (nextJob < jobCount && jobs[nextJob].blockCount <= 0) {
+                    nextJob++;
+                }
+                if (nextJob < jobCount) {
+                    laneJob[lane] = nextJob++;
+                    laneBlock[lane] = 0;
+                    active++;
+                }
+            }
+
+            // With only a few messages left, eight lanes are mostly wasted work.
+            if (nextJob >= jobCount && active < 3) {
+                for (int lane = 0; lane < Lanes; lane++) {
+                    if (laneJob[lane] >= 0) {
+                        const Job &job = jobs[laneJob[lane]];
+                        compressScalar(*job.state, job.blocks + laneBlock[lane] * BlockSize,
+                                       job.blockCount - laneBlock[lane]);
+                    }
+                }
+                return;
+            }
+
+            for (int lane = 0; lane < Lanes; lane++) {
+                if (laneJob[lane] >= 0) {
+                    const Job &job = jobs[laneJob[lane]];
+                    states[lane] = job.state;
+                    blocks[lane] = job.blocks + laneBlock[lane] * BlockSize;
+                } else {
+                    states[lane] = &idleStates[lane];
+                    blocks[lane] = idleBlock;
+                }
+            }
+
+            compressAvx2x8(states, blocks);
+
+            for (int lane = 0; lane < Lanes; lane++) {
+                if (laneJob[lane] >= 0 && ++laneBlock[lane] == jobs[laneJob[lane]].blockCount) {
+                    laneJob[lane] = -1;
+                    active--;
+                }
+            }
+        }
+    }
+#endif
+
+    for (int i = 0; i < jobCount; i++) {
+        compress(*jobs[i].state, jobs[i].blocks, jobs[i].blockCount, implementation);
+    }
+}
+
+void KQOAuthSha1::hmacBatch(const char * const *messages, const int *messageLengths,
+                            const char * const *keys, const int *keyLengths,
+                            int count, uchar *digests, Implementation implementation) {
+    if (count <= 0) {
+        return;
+    }
+
+    QVarLengthArray<State, 32> inner(count);
+    QVarLengthArray<State, 32> outer(count);
+    QVarLengthArray<Job, 64> jobs(2 * count);
+
+    /* http://tools.ietf.org/html/rfc2104  - (1), (2) & (5) */
+    // Pad blocks are only built for keys that differ from the previous message's key.
+    QVarLengthArray<uchar, 2 * BlockSize * 4> pads;
+    QVarLengthArray<int, 32> keyIndex(count);
+    int keyCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && keys[i] == keys[i - 1] && keyLengths[i] == keyLengths[i - 1]) {
+            keyIndex[i] = keyIndex[i - 1];
+            continue;
+        }
+
+        uchar keyBlock[BlockSize];
+        memset(keyBlock, 0, BlockSize);
+        if (keyLengths[i] > BlockSize) {
+            KQOAuthSha1 keyHash(implementation);
+            keyHash.addData(keys[i], keyLengths[i]);
+            keyHash.result(keyBlock);
+        } else {
+            memcpy(keyBlock, keys[i], keyLengths[i]);
+        }
+
+        pads.resize((keyCount + 1) * 2 * BlockSize);
+        uchar *ipad = pads.data() + keyCount * 2 * BlockSize;
+        uchar *opad = ipad + BlockSize;
+        for (int j = 0; j < BlockSize; j++) {
+            ipad[j] = keyBlock[j] ^ 0x36;
+            opad[j] = keyBlock[j] ^ 0x5c;
+        }
+
+        keyIndex[i] = keyCount++;
+    }
+
+    // The pad jobs hash into the first keyCount states, then get copied to every message.
+    for (int k = 0; k < keyCount; k++) {
+        inner[k] = initialState();
+        outer[k] = initialState();
+        Job innerPad = { &inner[k], pads.constData() + k * 2 * BlockSize, 1 };
+        Job outerPad = { &outer[k], pads.constData() + k * 2 * BlockSize + BlockSize, 1 };
+        jobs[2 * k] = innerPad;
+        jobs[2 * k + 1] = outerPad;
+    }
+    compressBatch(jobs.data(), 2 * keyCount, implementation);
+    for (int i = count - 1; i >= 0; i--) {
+        inner[i] = inner[keyIndex[i]];
+        outer[i] = outer[keyIndex[i]];
+    }
+
+    /* http://tools.ietf.org/html/rfc2104 - (3) & (4) */
+    // Full blocks are hashed straight from the messages. The tails with the SHA-1 padding
+    // need one or two more blocks each.
+    QVarLengthArray<uchar, 2 * BlockSize * 16> tails(count * 2 * BlockSize);
+    for (int i = 0; i < count; i++) {
+        const int fullBlocks = messageLengths[i] / BlockSize;
+        const int tailLength = messageLengths[i] - fullBlocks * BlockSize;
+        const quint64 bitLength = (quint64(BlockSize) + messageLengths[i]) * 8;
+
+        uchar *tail = tails.data() + i * 2 * BlockSize;
+        const int tailBlocks = (tailLength + 1 + 8 > BlockSize) ? 2 : 1;
+        memset(tail, 0, tailBlocks * BlockSize);
+        memcpy(tail, messages[i] + fullBlocks * BlockSize, tailLength);
+        tail[tailLength] = 0x80;
+        writeBigEndian32(tail + tailBlocks * BlockSize - 8, quint32(bitLength >> 32));
+        writeBigEndian32(tail + tailBlocks * BlockSize - 4, quint32(bitLength));
+
+        Job body = { &inner[i], reinterpret_cast<const uchar *>(messages[i]), fullBlocks };
+        Job padding = { &inner[i], tail, tailBlocks };
+        jobs[i] = body;
+        jobs[count + i] = padding;
+    }
+    compressBatch(jobs.data(), count, implementation);
+    compressBatch(jobs.data() + count, count, implementation);
+
+    /* http://tools.ietf.org/html/rfc2104 - (6) & (7) */
+    // The outer message is the 20 byte inner digest after the 64 byte opad: one block.
+    for (int i = 0; i < count; i++) {
+        uchar *block = tails.data() + i * 2 * BlockSize;
+        memset(block, 0, BlockSize);
+        for (int j = 0; j < 5; j++) {
+            writeBigEndian32(block + j * 4, inner[i].h[j]);
+        }
+        block[DigestSize] = 0x80;
+        writeBigEndian32(block + BlockSize - 4, (BlockSize + DigestSize) * 8);
+
+        Job outerJob = { &outer[i], block, 1 };
+        jobs[i] = outerJob;
+    }
+    compressBatch(jobs.data(), count, implementation);
+
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < 5; j++) {
+            writeBigEndian32(digests + i * DigestSize + j * 4, outer[i].h[j]);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHSHA1_P_H
+#define KQOAUTHSHA1_P_H
+
+#include <QString>
+
+#include "kqoauthglobals.h"
+
+/**
+ * A small SHA-1 implementation that, unlike QCryptographicHash, gives access to the
+ * intermediate chaining state. This lets the HMAC code hash the key pads once and
+ * resume from the saved midstates for every message.
+ *
+ * The block function is picked at runtime from the CPU features: SHA-NI if available,
+ * otherwise portable C. Batches of independent messages are additionally hashed
+ * eight at a time with AVX2 when the CPU has it but lacks SHA-NI.
+ */
+class KQOAUTH_EXPORT KQOAuthSha1
+{
+public:
+    enum {
+        BlockSize = 64,
+        DigestSize = 20
+    };
+
+    enum Implementation {
+        AutomaticImplementation = 0,    // Best one the CPU supports.
+        ScalarImplementation,           // Portable C.
+        Avx2Implementation,             // 8 lane multi-buffer AVX2, for batches only.
+        ShaNiImplementation             // Intel SHA extensions.
+    };
+
+    struct State {
+        quint32 h[5];
+    };
+
+    // One run of consecutive blocks to compress into 'state'.
+    struct Job {
+        State *state;
+        const uchar *blocks;
+        int blockCount;
+    };
+
+    // Every function that takes an implementation uses the detected one by default. Tests and
+    // benchmarks pass one explicitly; one the CPU does not support means the detected one.
+    explicit KQOAuthSha1(Implementation implementation = AutomaticImplementation);
+    // Resume hashing from a midstate taken after 'processedBytes' bytes (a multiple of BlockSize).
+    KQOAuthSha1(const State &midstate, quint64 processedBytes,
+                Implementation implementation = AutomaticImplementation);
+
+    void addData(const char *data, int length);
+    void result(uchar *digest);
+
+    // The chaining state. Only meaningful when the processed length is a multiple of BlockSize.
+    State state() const;
+
+    static State initialState();
+    static void compress(State &state, const uchar *blocks, int blockCount,
+                         Implementation implementation = AutomaticImplementation);
+
+    // Compress several independent jobs. Jobs must not share a state.
+    static void compressBatch(Job *jobs, int jobCount, Implementation implementation = AutomaticImplementation);
+
+    // HMAC-SHA1 of 'count' messages. Writes DigestSize bytes per message to 'digests'.
+    // Consecutive messages with the same key pointer share the key setup.
+    static void hmacBatch(const char * const *messages, const int *messageLengths,
+                          const char * const *keys, const int *keyLengths,
+                          int count, uchar *digests,
+                          Implementation implementation = AutomaticImplementation);
+
+    // The implementation detected from the CPU features.
+    static Implementation implementation();
+    static bool isSupported(KQOAuthSha1::Implementation implementation);
+
+private:
+    Implementation used;
+    State chain;
+    quint64 length;
+    uchar buffer[BlockSize];
+    int bufferLength;
+};
+
+#endif // KQOAUTHSHA1_P_H
@@ -0,0 +1,148 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+
+#include <QtDebug>
+
+#include "kqoauthsigner_p.h"
+#include "kqoauthrequest_p.h"
+#include "kqoauthutils.h"
+#include "kqoauthcryptobackend_p.h"
+#include "kqoauthsigningcontext_p.h"
+#include "kqoauthrsakey_p.h"
+#include "kqoauthpercentencoder_p.h"
+#include "kqoautharena_p.h"
+
+/**
+ * http://oauth.net/core/1.0/#anchor22
+ * The signature is the encoded consumer secret and token secret separated by '&', percent
+ * encoded once more as the parameter value.
+ */
+inline void KQOAuthPlaintextSigner::sign(KQOAuthRequestPrivate &request, const char *, int, QByteArray &out) {
+    QByteArray key;
+    KQOAuthPercentEncoder::append(key, request.oauthConsumerSecretKey);
+    key.append('&');
+    KQOAuthPercentEncoder::append(key, request.oauthTokenSecret);
+    KQOAuthPercentEncoder::append(out, key);
+}
+
+/**
+ * http://oauth.net/core/1.0/#anchor16
+ * The HMAC-SHA1 signature method uses the HMAC-SHA1 signature algorithm as defined in [RFC2104] where the
+ * Signature Base String is the text and the key is the concatenated values (each first encoded per Parameter
+ * Encoding) of the Consumer Secret and Token Secret, separated by an ‘&’ character (ASCII code 38) even if empty.
+ **/
+inline void KQOAuthHmacSha1Signer::sign(KQOAuthRequestPrivate &request, const char *baseString, int length,
+                                        QByteArray &out) {
+    // The key pads only depend on the secrets, so they are hashed once per credential pair.
+    if (request.signingContext.isNull()
+            || !request.signingContext->matches(request.oauthConsumerSecretKey, request.oauthTokenSecret)) {
+        request.signingContext = QSharedPointer<const KQOAuthSigningContext>(
+                    new KQOAuthSigningContext(request.oauthConsumerSecretKey, request.oauthTokenSecret));
+    }
+
+    uchar digest[KQOAuthCryptoBackend::DigestSize];
+    if (!request.signingContext->hmacSha1(baseString, length, digest)) {
+        qWarning() << "HMAC-SHA1 signing failed. The request will not be signed correctly.";
+        return;
+    }
+
+    const int start = out.size();
+    out.resize(start + KQOAuthUtils::MaxPercentEncodedSha1Length);
+    const int written = KQOAuthUtils::writePercentEncodedBase64(out.data() + start, digest,
+                                                                KQOAuthCryptoBackend::DigestSize);
+    out.resize(start + written);
+}
+
+// The signature KQOAuthManager computed off the calling thread is used if it was computed
+// from the same base string.
+inline void KQOAuthRsaSha1Signer::sign(KQOAuthRequestPrivate &request, const char *baseString, int length,
+                                       QByteArray &out) {
+    QByteArray signature;
+    if (!request.presignedSignature.isEmpty()
+            && request.presignedBaseString.size() == length
+            && memcmp(request.presignedBaseString.constData(), baseString, length) == 0) {
+        signature = request.presignedSignature;
+    } else {
+        // The consumer secret is the PEM encoded private key. Parse it only once.
+        if (request.rsaKey.isNull() || !request.rsaKey->matches(request.oauthConsumerSecretKey)) {
+            request.rsaKey = KQOAuthRsaKey::fromPem(request.oauthConsumerSecretKey);
+        }
+
+        if (request.rsaKey.isNull()) {
+            qWarning() << "Cannot parse the RSA private key. The request will not be signed correctly.";
+        } else {
+            signature = request.rsaKey->sign(baseString, length);
+        }
+    }
+    request.presignedBaseString.clear();
+    request.presignedSignature.clear();
+
+    if (!signature.isEmpty()) {
+        const int start = out.size();
+        out.resize(start + KQOAuthUtils::percentEncodedBase64Length(signature.size()));
+        const int written = KQOAuthUtils::writePercentEncodedBase64(out.data() + start,
+                                                                    reinterpret_cast<const uchar *>(signature.constData()),
+                                                                    signature.size());
+        out.resize(start + written);
+    }
+}
+
+template <class Policy>
+void KQOAuthSigner::sign(KQOAuthRequestPrivate &request, KQOAuthArena &arena, QByteArray &out) {
+    int length = 0;
+    const char *baseString = 0;
+    if (Policy::NeedsBaseString) {
+        baseString = request.requestBaseString(arena, &length);
+    }
+    Policy::sign(request, baseString, length, out);
+}
+
+KQOAuthSigner::SignFunction KQOAuthSigner::forMethod(KQOAuthRequest::RequestSignatureMethod method) {
+    switch (method) {
+    case KQOAuthRequest::PLAINTEXT:
+        return &KQOAuthSigner::sign<KQOAuthPlaintextSigner>;
+    case KQOAuthRequest::HMAC_SHA1:
+        return &KQOAuthSigner::sign<KQOAuthHmacSha1Signer>;
+    case KQOAuthRequest::RSA_SHA1:
+        return &KQOAuthSigner::sign<KQOAuthRsaSha1Signer>;
+    default:
+        return 0;
+    }
+}
+
+const QString &KQOAuthSigner::methodName(KQOAuthRequest::RequestSignatureMethod method) {
+    // Shared, so setting the method on every request does not allocate.
+    static const QString plaintext("PLAINTEXT");
+    static const QString hmacSha1("HMAC-SHA1");
+    static const QString rsaSha1("RSA-SHA1");
+    static const QString none;
+
+    switch (method) {
+    case KQOAuthRequest::PLAINTEXT:
+        return plaintext;
+    case KQOAuthRequest::HMAC_SHA1:
+        return hmacSha1;
+    case KQOAuthRequest::RSA_SHA1:
+        return rsaSha1;
+    default:
+        return none;
+    }
+}
@@ -0,0 +1,76 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHSIGNER_P_H
+#define KQOAUTHSIGNER_P_H
+
+#include <QString>
+#include <QByteArray>
+
+#include "kqoauthglobals.h"
+#include "kqoauthrequest.h"
+
+class KQOAuthRequestPrivate;
+class KQOAuthArena;
+
+/**
+ * The signature methods as policies. Each one appends the percent encoded oauth_signature of
+ * a request to 'out', from the base string if it needs one. PLAINTEXT signs without one, so
+ * it is never built.
+ */
+struct KQOAuthPlaintextSigner
+{
+    enum { NeedsBaseString = 0 };
+    static void sign(KQOAuthRequestPrivate &request, const char *baseString, int length, QByteArray &out);
+};
+
+struct KQOAuthHmacSha1Signer
+{
+    enum { NeedsBaseString = 1 };
+    static void sign(KQOAuthRequestPrivate &request, const char *baseString, int length, QByteArray &out);
+};
+
+struct KQOAuthRsaSha1Signer
+{
+    enum { NeedsBaseString = 1 };
+    static void sign(KQOAuthRequestPrivate &request, const char *baseString, int length, QByteArray &out);
+};
+
+/**
+ * Picks the signing function of a signature method. A request looks it up once, when its
+ * signature method is set, and then calls it for every signature without looking at the
+ * method again. Each function is one of the policies above compiled into sign().
+ */
+class KQOAUTH_EXPORT KQOAuthSigner
+{
+public:
+    typedef void (*SignFunction)(KQOAuthRequestPrivate &request, KQOAuthArena &arena, QByteArray &out);
+
+    // Returns 0 for an unknown method.
+    static SignFunction forMethod(KQOAuthRequest::RequestSignatureMethod method);
+    // The oauth_signature_method value, shared by all requests.
+    static const QString &methodName(KQOAuthRequest::RequestSignatureMethod method);
+
+private:
+    template <class Policy>
+    static void sign(KQOAuthRequestPrivate &request, KQOAuthArena &arena, QByteArray &out);
+};
+
+#endif // KQOAUTHSIGNER_P_H
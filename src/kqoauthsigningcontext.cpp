@@ -0,0 +1,91 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "kqoauthsigningcontext_p.h"
+#include "kqoauthcryptobackend_p.h"
+#include "kqoauthpercentencoder_p.h"
+
+KQOAuthSigningContext::KQOAuthSigningContext(const QString &consumerSecretKey, const QString &tokenSecret) :
+    consumerSecretKey(consumerSecretKey),
+    tokenSecret(tokenSecret),
+    backend(KQOAuthUtils::cryptoBackend())
+{
+    KQOAuthPercentEncoder::append(key, consumerSecretKey);
+    key.append('&');
+    KQOAuthPercentEncoder::append(key, tokenSecret);
+
+    hmacKey = QSharedPointer<const KQOAuthHmacSha1Key>(
+                KQOAuthCryptoBackend::instance(backend)->createHmacSha1Key(key.constData(), key.size()));
+}
+
+bool KQOAuthSigningContext::matches(const QString &consumerSecretKey, const QString &tokenSecret) const {
+    return this->consumerSecretKey == consumerSecretKey && this->tokenSecret == tokenSecret
+            && backend == KQOAuthUtils::cryptoBackend();
+}
+
+QByteArray KQOAuthSigningContext::signingKey() const {
+    return key;
+}
+
+QByteArray KQOAuthSigningContext::hmacSha1(const QByteArray &message) const {
+    QByteArray digest(KQOAuthCryptoBackend::DigestSize, Qt::Uninitialized);
+    if (!hmacSha1(message.constData(), message.size(), reinterpret_cast<uchar *>(digest.data()))) {
+        return QByteArray();
+    }
+    return digest;
+}
+
+bool KQOAuthSigningContext::hmacSha1(const char *message, int length, uchar *digest) const {
+    return hmacKey->sign(message, length, digest);
+}
+
+
+KQOAuthSigningContextCache::KQOAuthSigningContextCache(int maxContexts) :
+    maxContexts(maxContexts)
+{
+}
+
+QSharedPointer<const KQOAuthSigningContext> KQOAuthSigningContextCache::context(const QString &consumerSecretKey,
+                                                                               const QString &tokenSecret) {
+    const QPair<QString, QString> credentials = qMakePair(consumerSecretKey, tokenSecret);
+
+    // A context set up by another backend than the selected one is replaced.
+    QSharedPointer<const KQOAuthSigningContext> signingContext = contexts.value(credentials);
+    if (!signingContext.isNull() && signingContext->matches(consumerSecretKey, tokenSecret)) {
+        return signingContext;
+    }
+
+    // The working set of credentials is expected to be small. If it is not, start over
+    // instead of growing without bounds. Requests keep their own reference to contexts in use.
+    if (signingContext.isNull() && contexts.size() >= maxContexts) {
+        contexts.clear();
+    }
+
+    signingContext = QSharedPointer<const KQOAuthSigningContext>(new KQOAuthSigningContext(consumerSecretKey, tokenSecret));
+    contexts.insert(credentials, signingContext);
+    return signingContext;
+}
+
+int KQOAuthSigningContextCache::count() const {
+    return contexts.size();
+}
+
+void KQOAuthSigningContextCache::clear() {
+    contexts.clear();
+}
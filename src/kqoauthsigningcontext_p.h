@@ -0,0 +1,84 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@gmail.com)
+ *         http://www.johanpaul.com
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+// Note this class shouldn't be copied or used and the implementation might change later.
+#ifndef KQOAUTHSIGNINGCONTEXT_P_H
+#define KQOAUTHSIGNINGCONTEXT_P_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
+
+#include "kqoauthglobals.h"
+#include "kqoauthutils.h"
+
+class KQOAuthHmacSha1Key;
+
+/**
+ * HMAC-SHA1 signing context for one (consumer secret, token secret) pair.
+ * The signing key is percent encoded and set up by the selected crypto backend only once,
+ * when the context is created. Signing a message then only hashes the message itself.
+ * A context is immutable after construction, so it can be shared freely between requests.
+ */
+class KQOAUTH_EXPORT KQOAuthSigningContext
+{
+public:
+    KQOAuthSigningContext(const QString &consumerSecretKey, const QString &tokenSecret);
+
+    // Also false once another crypto backend has been selected.
+    bool matches(const QString &consumerSecretKey, const QString &tokenSecret) const;
+
+    // The HMAC key: encoded consumer secret and token secret separated by '&'.
+    QByteArray signingKey() const;
+
+    // Returns the raw 20 byte HMAC-SHA1 digest of the message, or an empty array if the
+    // backend failed.
+    QByteArray hmacSha1(const QByteArray &message) const;
+    bool hmacSha1(const char *message, int length, uchar *digest) const;
+
+private:
+    QString consumerSecretKey;
+    QString tokenSecret;
+    QByteArray key;
+    KQOAuthUtils::CryptoBackend backend;
+    QSharedPointer<const KQOAuthHmacSha1Key> hmacKey;
+};
+
+/**
+ * Cache of signing contexts keyed by the credential pair. KQOAuthManager owns one and
+ * hands the contexts to the requests it executes.
+ */
+class KQOAUTH_EXPORT KQOAuthSigningContextCache
+{
+public:
+    explicit KQOAuthSigningContextCache(int maxContexts = 1024);
+
+    QSharedPointer<const KQOAuthSigningContext> context(const QString &consumerSecretKey,
+                                                        const QString &tokenSecret);
+    int count() const;
+    void clear();
+
+private:
+    QHash< QPair<QString, QString>, QSharedPointer<const KQOAuthSigningContext> > contexts;
+    int maxContexts;
+};
+
+#endif // KQOAUTHSIGNINGCONTEXT_P_H
@@ -18,125 +18,215 @@
  *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <QString>
-#include <QCryptographicHash>
+#include <QAtomicInt>
 #include <QByteArray>
+#include <QVarLengthArray>
+#include <QIODevice>
+#include <QScopedPointer>
 
 #include <QtDebug>
 #include "kqoauthutils.h"
+#include "kqoauthcryptobackend_p.h"
+#include "kqoauthrsakey_p.h"
 
-#include <openssl/pem.h>
-#include <openssl/err.h>
-#include <openssl/ssl.h>
-#include <openssl/evp.h>
 
+static QBasicAtomicInt selectedCryptoBackend = Q_BASIC_ATOMIC_INITIALIZER(-1);
+
+static int loadCryptoBackend() {
+#if QT_VERSION >= 0x050000
+    return selectedCryptoBackend.loadAcquire();
+#else
+    return selectedCryptoBackend;
+#endif
+}
+
+void KQOAuthUtils::setCryptoBackend(KQOAuthUtils::CryptoBackend backend) {
+    selectedCryptoBackend.fetchAndStoreOrdered(backend);
+}
+
+KQOAuthUtils::CryptoBackend KQOAuthUtils::cryptoBackend() {
+    int backend = loadCryptoBackend();
+    if (backend < 0) {
+        // Nothing selected yet. Pick the default once, unless someone was faster.
+        const QByteArray name = qgetenv("KQOAUTH_CRYPTO_BACKEND");
+        if (name == "qt") {
+            backend = QtCryptoBackend;
+        } else if (name == "builtin") {
+            backend = BuiltinCryptoBackend;
+        } else {
+            if (!name.isEmpty() && name != "openssl") {
+                qWarning() << "KQOAuthUtils: Unknown crypto backend" << name << "- using openssl.";
+            }
+            backend = OpenSslCryptoBackend;
+        }
+        selectedCryptoBackend.testAndSetOrdered(-1, backend);
+        backend = loadCryptoBackend();
+    }
+
+    return KQOAuthUtils::CryptoBackend(backend);
+}
 
 QString KQOAuthUtils::hmac_sha1(const QString &message, const QString &key)
 {
-    QByteArray keyBytes = key.toLatin1();
-    int keyLength;              // Lenght of key word
-    const int blockSize = 64;   // Both MD5 and SHA-1 have a block size of 64.
+    const QByteArray utf8 = message.toUtf8();
+    return QString(hmac_sha1(utf8.constData(), utf8.size(), key.toUtf8()));
+}
 
-    keyLength = keyBytes.size();
-    // If key is longer than block size, we need to hash the key
-    if (keyLength > blockSize) {
-        QCryptographicHash hash(QCryptographicHash::Sha1);
-        hash.addData(keyBytes);
-        keyBytes = hash.result();
+QByteArray KQOAuthUtils::hmac_sha1(const char *message, int length, const QByteArray &key)
+{
+    uchar digest[KQOAuthCryptoBackend::DigestSize];
+    if (!KQOAuthCryptoBackend::instance(cryptoBackend())->hmacSha1(message, length, key.constData(), key.size(), digest)) {
+        return QByteArray();
     }
+    return QByteArray::fromRawData(reinterpret_cast<const char *>(digest), KQOAuthCryptoBackend::DigestSize).toBase64();
+}
 
-    /* http://tools.ietf.org/html/rfc2104  - (1) */
-    // Create the opad and ipad for the hash function.
-    QByteArray ipad;
-    QByteArray opad;
+QStringList KQOAuthUtils::hmac_sha1_batch(const QList<QByteArray> &messages, const QList<QByteArray> &keys)
+{
+    QStringList signatures;
+    const int count = messages.size();
 
-    ipad.fill( 0, blockSize);
-    opad.fill( 0, blockSize);
+    if (keys.size() != 1 && keys.size() != count) {
+        qWarning() << "KQOAuthUtils::hmac_sha1_batch: Need one key, or one key per message.";
+        return signatures;
+    }
 
-    ipad.replace(0, keyBytes.length(), keyBytes);
-    opad.replace(0, keyBytes.length(), keyBytes);
+    QVarLengthArray<const char *, 64> messageData(count);
+    QVarLengthArray<int, 64> messageLengths(count);
+    QVarLengthArray<const char *, 64> keyData(count);
+    QVarLengthArray<int, 64> keyLengths(count);
+    for (int i = 0; i < count; i++) {
+        const QByteArray &key = (keys.size() == 1) ? keys.at(0) : keys.at(i);
+        messageData[i] = messages.at(i).constData();
+        messageLengths[i] = messages.at(i).size();
+        keyData[i] = key.constData();
+        keyLengths[i] = key.size();
+    }
 
-    /* http://tools.ietf.org/html/rfc2104 - (2) & (5) */
-    for (int i=0; i<64; i++) {
-        ipad[i] = ipad[i] ^ 0x36;
-        opad[i] = opad[i] ^ 0x5c;
+    QByteArray digests(count * KQOAuthCryptoBackend::DigestSize, Qt::Uninitialized);
+    if (!KQOAuthCryptoBackend::instance(cryptoBackend())->hmacSha1Batch(messageData.constData(), messageLengths.constData(),
+                                                                        keyData.constData(), keyLengths.constData(),
+                                                                        count, reinterpret_cast<uchar *>(digests.data()))) {
+        return signatures;
     }
 
-    QByteArray workArray;
-    workArray.clear();
+    for (int i = 0; i < count; i++) {
+        signatures.append(QString(digests.mid(i * KQOAuthCryptoBackend::DigestSize,
+                                              KQOAuthCryptoBackend::DigestSize).toBase64()));
+    }
 
-    workArray.append(ipad, 64);
-    /* http://tools.ietf.org/html/rfc2104 - (3) */
-    workArray.append(message.toLatin1());
+    return signatures;
+}
 
+QString KQOAuthUtils::rsa_sha1(const QString &message, const QString &key)
+{
+    const QByteArray utf8 = message.toUtf8();
+    return QString(rsa_sha1(utf8.constData(), utf8.size(), key));
+}
 
-    /* http://tools.ietf.org/html/rfc2104 - (4) */
-    QByteArray sha1 = QCryptographicHash::hash(workArray, QCryptographicHash::Sha1);
+QByteArray KQOAuthUtils::rsa_sha1(const char *message, int length, const QString &key)
+{
+    // The key is parsed only the first time it is seen.
+    QSharedPointer<KQOAuthRsaKey> rsaKey = KQOAuthRsaKey::fromPem(key);
+    if (rsaKey.isNull()) {
+        return QByteArray();
+    }
 
-    /* http://tools.ietf.org/html/rfc2104 - (6) */
-    workArray.clear();
-    workArray.append(opad, 64);
-    workArray.append(sha1);
+    return rsaKey->sign(message, length).toBase64();
+}
 
-    sha1.clear();
+int KQOAuthUtils::percentEncodedBase64Length(int length) {
+    return 3 * 4 * ((length + 2) / 3);
+}
 
-    /* http://tools.ietf.org/html/rfc2104 - (7) */
-    sha1 = QCryptographicHash::hash(workArray, QCryptographicHash::Sha1);
-    return QString(sha1.toBase64());
+// Base64 output characters that are not in the unreserved set: '+', '/' and the '=' padding.
+static inline char *writeBase64Char(char *out, char c) {
+    switch (c) {
+    case '+':
+        *out++ = '%'; *out++ = '2'; *out++ = 'B';
+        break;
+    case '/':
+        *out++ = '%'; *out++ = '2'; *out++ = 'F';
+        break;
+    case '=':
+        *out++ = '%'; *out++ = '3'; *out++ = 'D';
+        break;
+    default:
+        *out++ = c;
+        break;
+    }
+    return out;
 }
 
-QString KQOAuthUtils::rsa_sha1(const QString &message, const QString &key)
-{
-    SSL_load_error_strings();
-    OpenSSL_add_all_algorithms();
-    OpenSSL_add_all_ciphers();
-    OpenSSL_add_all_digests();
+int KQOAuthUtils::writePercentEncodedBase64(char *out, const uchar *data, int length) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char *p = out;
+
+    int i = 0;
+    for (; i + 2 < length; i += 3) {
+        const quint32 triple = (quint32(data[i]) << 16) | (quint32(data[i + 1]) << 8) | quint32(data[i + 2]);
+        p = writeBase64Char(p, alphabet[(triple >> 18) & 0x3F]);
+        p = writeBase64Char(p, alphabet[(triple >> 12) & 0x3F]);
+        p = writeBase64Char(p, alphabet[(triple >> 6) & 0x3F]);
+        p = writeBase64Char(p, alphabet[triple & 0x3F]);
+    }
 
-    EVP_PKEY *evpKey = 0;
-    evpKey = EVP_PKEY_new();
+    if (i < length) {
+        quint32 triple = quint32(data[i]) << 16;
+        if (i + 1 < length) {
+            triple |= quint32(data[i + 1]) << 8;
+        }
+        p = writeBase64Char(p, alphabet[(triple >> 18) & 0x3F]);
+        p = writeBase64Char(p, alphabet[(triple >> 12) & 0x3F]);
+        p = writeBase64Char(p, (i + 1 < length) ? alphabet[(triple >> 6) & 0x3F] : '=');
+        p = writeBase64Char(p, '=');
+    }
 
-    RSA *rsa = 0;
-    rsa = getRsaFromKey(key);
+    return int(p - out);
+}
 
-    EVP_PKEY_set1_RSA(evpKey, rsa);
+static QString sha1Base64(KQOAuthSha1Digest *sha1) {
+    uchar digest[KQOAuthCryptoBackend::DigestSize];
+    if (!sha1->result(digest)) {
+        return QString();
+    }
+    return QString::fromLatin1(QByteArray::fromRawData(reinterpret_cast<const char *>(digest),
+                                                       KQOAuthCryptoBackend::DigestSize).toBase64());
+}
 
-    EVP_MD_CTX* ctx = 0;
-    ctx = EVP_MD_CTX_create();
-    EVP_SignInit_ex(ctx, EVP_sha1(), 0);
-    QByteArray latinMessage = message.toLatin1();
-    EVP_SignUpdate(ctx, latinMessage.data(), strlen(latinMessage.data()));
+QString KQOAuthUtils::bodyHash(const QByteArray &body) {
+    QScopedPointer<KQOAuthSha1Digest> sha1(KQOAuthCryptoBackend::instance(cryptoBackend())->createSha1());
+    sha1->addData(body.constData(), body.size());
+    return sha1Base64(sha1.data());
+}
 
-    const int MAX_LEN = 1024;
-    unsigned char *sig = new unsigned char[MAX_LEN];
-    unsigned int sigLen;
+QString KQOAuthUtils::bodyHash(QIODevice *device) {
+    if (device == 0 || !device->isReadable()) {
+        qWarning() << "KQOAuthUtils::bodyHash: The device is not open for reading.";
+        return QString();
+    }
 
-    EVP_SignFinal(ctx, sig, &sigLen, evpKey);
-    sig[sigLen] = '\0';
+    if (device->isSequential()) {
+        qWarning() << "KQOAuthUtils::bodyHash: A sequential device cannot be hashed and then uploaded.";
+        return QString();
+    }
 
-    EVP_MD_CTX_destroy(ctx);
-    RSA_free(rsa);
-    EVP_PKEY_free(evpKey);
-    ERR_free_strings();
+    const qint64 start = device->pos();
+    QScopedPointer<KQOAuthSha1Digest> sha1(KQOAuthCryptoBackend::instance(cryptoBackend())->createSha1());
+    char chunk[BodyHashChunkSize];
+    qint64 read;
+    while ((read = device->read(chunk, BodyHashChunkSize)) > 0) {
+        sha1->addData(chunk, int(read));
+    }
 
-    QByteArray ret((char *)sig, sigLen);
+    if (!device->seek(start)) {
+        qWarning() << "KQOAuthUtils::bodyHash: Could not rewind the device.";
+    }
 
-    return QString(ret.toBase64());
-}
+    if (read < 0) {
+        qWarning() << "KQOAuthUtils::bodyHash: Reading the device failed:" << device->errorString();
+        return QString();
+    }
 
-RSA* KQOAuthUtils::getRsaFromKey(const QString &key)
-{
-    BIO *bufio;
-    QByteArray data = key.toLocal8Bit();
-    char *pem_key_buffer = data.data();
-    int pem_key_buffer_len = strlen(pem_key_buffer);
-
-    bufio = BIO_new_mem_buf((void*)pem_key_buffer, pem_key_buffer_len);
-    RSA *rsa = 0;
-    rsa = RSA_new();
-    rsa = PEM_read_bio_RSAPrivateKey(bufio, 0, 0, NULL);
-    if (rsa == 0) {
-        printf("Can not parse RSA data. Errors:\n");
-        ERR_print_errors_fp(stderr);
-        exit(1);
-    }
-    return rsa;
+    return sha1Base64(sha1.data());
 }
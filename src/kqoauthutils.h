@@ -22,18 +22,63 @@
 
 #include "kqoauthglobals.h"
 
-#include <openssl/rsa.h>
+#include <QList>
+#include <QByteArray>
+#include <QStringList>
 
 class QString;
+class QIODevice;
 class KQOAUTH_EXPORT KQOAuthUtils
 {
 public:
 
+    enum {
+        // Base64 of a SHA-1 digest is 28 characters, and each might need "%XX".
+        MaxPercentEncodedSha1Length = 3 * 28,
+        // How much of a body bodyHash() reads from the device at a time.
+        BodyHashChunkSize = 16 * 1024
+    };
+
+    enum CryptoBackend {
+        QtCryptoBackend = 0,        // Hand built HMAC on top of QCryptographicHash.
+        OpenSslCryptoBackend,       // OpenSSL EVP digests with per thread contexts (default).
+        BuiltinCryptoBackend        // SHA-1 with SHA-NI, AVX2 for batches, or portable C.
+    };
+
+    // Select the implementation of every digest the library computes. The default can also be
+    // chosen with the KQOAUTH_CRYPTO_BACKEND environment variable ("qt", "openssl" or "builtin").
+    static void setCryptoBackend(KQOAuthUtils::CryptoBackend backend);
+    static KQOAuthUtils::CryptoBackend cryptoBackend();
+
+    // The message and the key are signed as UTF-8, the way the request builds its base string.
     static QString hmac_sha1(const QString &message, const QString &key);
+    // Same as above for bytes, such as a base string from the request. Nothing is transcoded
+    // or copied. Returns the base64 encoded signature.
+    static QByteArray hmac_sha1(const char *message, int length, const QByteArray &key);
+
+    // HMAC-SHA1 of many messages at once. 'keys' has either one key for all messages or one
+    // key per message. Returns the base64 encoded signatures in message order, the same as
+    // hmac_sha1() would. The builtin backend uses SHA-NI or 8 lane AVX2 when the CPU supports them.
+    static QStringList hmac_sha1_batch(const QList<QByteArray> &messages, const QList<QByteArray> &keys);
+
+    // Returns an empty string if the key cannot be parsed. The message is signed as UTF-8.
     static QString rsa_sha1(const QString &message, const QString &key);
+    static QByteArray rsa_sha1(const char *message, int length, const QString &key);
+
+    // Base64 encodes 'data' and percent encodes the result in the same pass, the way a signature
+    // goes into a request. 'out' needs room for percentEncodedBase64Length(length) bytes.
+    // Returns the number of bytes written. Does not allocate.
+    static int writePercentEncodedBase64(char *out, const uchar *data, int length);
+    static int percentEncodedBase64Length(int length);
 
-private:
-    static RSA* getRsaFromKey(const QString &key);
+    // The oauth_body_hash value of a request body, the base64 encoded SHA-1 of its bytes.
+    // http://oauth.googlecode.com/svn/spec/ext/body_hash/1.0/oauth-bodyhash.html
+    // The device version reads from the current position to the end in BodyHashChunkSize
+    // chunks, without holding the body in memory, and then seeks back so the same device
+    // can be uploaded. Returns an empty string if the device is not open for reading or is
+    // sequential and so cannot be read twice.
+    static QString bodyHash(const QByteArray &body);
+    static QString bodyHash(QIODevice *device);
 };
 
 #endif // KQOAUTHUTILS_H
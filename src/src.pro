@@ -23,6 +23,10 @@ PUBLIC_HEADERS += kqoauthmanager.h \
                   kqoauthrequest.h \
                   kqoauthrequest_1.h \
                   kqoauthrequest_xauth.h \
+                  kqoauthendpoint.h \
+                  kqoauthrequesttemplate.h \
+                  kqoauthrequestdata.h \
+                  kqoauthcredentials.h \
                   kqoauthglobals.h 
 
 PRIVATE_HEADERS +=  kqoauthrequest_p.h \
@@ -30,7 +34,23 @@ PRIVATE_HEADERS +=  kqoauthrequest_p.h \
                     kqoauthauthreplyserver.h \
                     kqoauthauthreplyserver_p.h \
                     kqoauthutils.h \
-                    kqoauthrequest_xauth_p.h
+                    kqoauthrequest_xauth_p.h \
+                    kqoauthsha1_p.h \
+                    kqoauthcryptobackend_p.h \
+                    kqoauthrsakey_p.h \
+                    kqoauthsigningcontext_p.h \
+                    kqoauthsigner_p.h \
+                    kqoauthinterntable_p.h \
+                    kqoauthrsasigningqueue_p.h \
+                    kqoauthbasestring_p.h \
+                    kqoauthparameterlist_p.h \
+                    kqoautharena_p.h \
+                    kqoauthcpufeatures_p.h \
+                    kqoauthpercentencoder_p.h \
+                    kqoauthendpoint_p.h \
+                    kqoauthrequesttemplate_p.h \
+                    kqoauthrequestdata_p.h \
+                    kqoauthcredentials_p.h
 
 HEADERS = \
     $$PUBLIC_HEADERS \
@@ -42,7 +62,23 @@ SOURCES += \
     kqoauthutils.cpp \
     kqoauthauthreplyserver.cpp \
     kqoauthrequest_1.cpp \
-    kqoauthrequest_xauth.cpp
+    kqoauthrequest_xauth.cpp \
+    kqoauthsha1.cpp \
+    kqoauthcryptobackend.cpp \
+    kqoauthrsakey.cpp \
+    kqoauthsigningcontext.cpp \
+    kqoauthsigner.cpp \
+    kqoauthinterntable.cpp \
+    kqoauthrsasigningqueue.cpp \
+    kqoauthbasestring.cpp \
+    kqoauthparameterlist.cpp \
+    kqoautharena.cpp \
+    kqoauthcpufeatures.cpp \
+    kqoauthpercentencoder.cpp \
+    kqoauthendpoint.cpp \
+    kqoauthrequesttemplate.cpp \
+    kqoauthrequestdata.cpp \
+    kqoauthcredentials.cpp
 
 DEFINES += KQOAUTH
 
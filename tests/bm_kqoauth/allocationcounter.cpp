@@ -0,0 +1,87 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@d-pointer.com)
+ *         http://www.d-pointer.com
+ *
+ *  KQOAuth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+
+#include "allocationcounter.h"
+
+static bool counting = false;
+static int allocationCount = 0;
+static qint64 allocationBytes = 0;
+
+#if defined(__GLIBC__)
+
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+
+void *malloc(size_t size) {
+    if (counting) {
+        allocationCount++;
+        allocationBytes += size;
+    }
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    if (counting) {
+        allocationCount++;
+        allocationBytes += count * size;
+    }
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+    if (counting) {
+        allocationCount++;
+        allocationBytes += size;
+    }
+    return __libc_realloc(pointer, size);
+}
+
+}
+
+bool AllocationCounter::isSupported() {
+    return true;
+}
+
+#else
+
+bool AllocationCounter::isSupported() {
+    return false;
+}
+
+#endif
+
+void AllocationCounter::start() {
+    allocationCount = 0;
+    allocationBytes = 0;
+    counting = true;
+}
+
+int AllocationCounter::stop() {
+    counting = false;
+    return allocationCount;
+}
+
+qint64 AllocationCounter::allocatedBytes() {
+    return allocationBytes;
+}
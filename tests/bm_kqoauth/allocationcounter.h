@@ -0,0 +1,40 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@d-pointer.com)
+ *         http://www.d-pointer.com
+ *
+ *  KQOAuth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <QtGlobal>
+
+// Counts heap allocations made by this process between start() and stop(). Works by
+// replacing malloc(), calloc() and realloc() in the benchmark binary, which is only
+// possible with glibc. Use isSupported() before relying on the numbers.
+class AllocationCounter
+{
+public:
+    static bool isSupported();
+
+    static void start();
+    // Returns the number of allocations since start().
+    static int stop();
+    // The number of bytes requested between the last start() and stop().
+    static qint64 allocatedBytes();
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,665 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@d-pointer.com)
+ *         http://www.d-pointer.com
+ *
+ *  KQOAuth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bm_kqoauth.h"
+
+// Qt includes
+#include <QtDebug>
+#include <QTest>
+#include <QUrl>
+#include <QtAlgorithms>
+#include <QVector>
+
+// Project includes
+#include <kqoauthutils.h>
+#include <kqoauthsigningcontext_p.h>
+#include <kqoauthsha1_p.h>
+#include <kqoauthpercentencoder_p.h>
+#include <kqoauthbasestring_p.h>
+#include <kqoauthrequest.h>
+#include <kqoauthrequest_1.h>
+#include <kqoauthrequesttemplate.h>
+#include <kqoauthrequestdata.h>
+#include <kqoauthcredentials.h>
+
+#include "allocationcounter.h"
+
+const QByteArray Bm_KQOAuth::baseString = QByteArray("POST&http%3A%2F%2Fapi.twitter.com%2F1%2Fstatuses%2Fupdate.xml&oauth_consumer_key%3D9PqhX2sX7DlmjNJ5j2Q%26oauth_nonce%3D9275bae57071b54b6077a9d5561d45ad%26oauth_signature_method%3DHMAC-SHA1%26oauth_timestamp%3D1288513281%26oauth_token%3D210109965-FPE2myUlNMCix2l5dyo9AlUvPu3VvIOvCTbd1CvJ%26oauth_version%3D1.0%26status%3Dsetting%2520up%2520my%2520twitter");
+
+// The number of distinct (consumer secret, token secret) pairs the requests are signed with.
+static void addCredentialRows() {
+    QTest::addColumn<int>("credentialPairs");
+
+    QTest::newRow("1 credential pair") << 1;
+    QTest::newRow("100 credential pairs") << 100;
+    QTest::newRow("500 credential pairs") << 500;
+}
+
+static QString consumerSecret(int i) {
+    return QString("1NYYhpIw1fXItywS9Bw6gGRmkRyF9zB54UXkTGcI8/%1").arg(i);
+}
+
+static QString tokenSecret(int i) {
+    return QString("CBP6yupjMl1VLEuN5EMcWm43QLf1MCO4jeSFr7jhOI+%1").arg(i);
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_data() {
+    addCredentialRows();
+}
+
+void Bm_KQOAuth::bm_hmac_sha1() {
+    QFETCH(int, credentialPairs);
+
+    int i = 0;
+    QBENCHMARK {
+        // This is what KQOAuthRequestPrivate::oauthSignature() used to do for every request.
+        QString secret = QString(QUrl::toPercentEncoding(consumerSecret(i))) + "&"
+                         + QString(QUrl::toPercentEncoding(tokenSecret(i)));
+        QString signature = KQOAuthUtils::hmac_sha1(baseString, secret);
+        Q_UNUSED(signature);
+        i = (i + 1) % credentialPairs;
+    }
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_signing_context_data() {
+    addCredentialRows();
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_signing_context() {
+    QFETCH(int, credentialPairs);
+
+    KQOAuthSigningContextCache cache;
+    int i = 0;
+    QBENCHMARK {
+        QString signature = QString(cache.context(consumerSecret(i), tokenSecret(i))->hmacSha1(baseString).toBase64());
+        Q_UNUSED(signature);
+        i = (i + 1) % credentialPairs;
+    }
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_backend_data() {
+    QTest::addColumn<int>("backend");
+
+    QTest::newRow("qt") << int(KQOAuthUtils::QtCryptoBackend);
+    QTest::newRow("builtin") << int(KQOAuthUtils::BuiltinCryptoBackend);
+    QTest::newRow("openssl") << int(KQOAuthUtils::OpenSslCryptoBackend);
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_backend() {
+    QFETCH(int, backend);
+
+    KQOAuthUtils::CryptoBackend previous = KQOAuthUtils::cryptoBackend();
+    KQOAuthUtils::setCryptoBackend(KQOAuthUtils::CryptoBackend(backend));
+
+    const QString message(baseString);
+    const QString key = QString(QUrl::toPercentEncoding(consumerSecret(0))) + "&"
+                        + QString(QUrl::toPercentEncoding(tokenSecret(0)));
+    QBENCHMARK {
+        QString signature = KQOAuthUtils::hmac_sha1(message, key);
+        Q_UNUSED(signature);
+    }
+
+    KQOAuthUtils::setCryptoBackend(previous);
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_bytes_data() {
+    QTest::addColumn<bool>("bytes");
+
+    QTest::newRow("QString") << false;
+    QTest::newRow("bytes") << true;
+}
+
+// Signing a base string the request built, through QString or as the bytes it already is.
+void Bm_KQOAuth::bm_hmac_sha1_bytes() {
+    QFETCH(bool, bytes);
+
+    const QByteArray key = QUrl::toPercentEncoding(consumerSecret(0)) + "&"
+                           + QUrl::toPercentEncoding(tokenSecret(0));
+    if (bytes) {
+        QBENCHMARK {
+            QByteArray signature = KQOAuthUtils::hmac_sha1(baseString.constData(), baseString.size(), key);
+            Q_UNUSED(signature);
+        }
+        return;
+    }
+
+    const QString keyString(key);
+    QBENCHMARK {
+        QString signature = KQOAuthUtils::hmac_sha1(QString(baseString), keyString);
+        Q_UNUSED(signature);
+    }
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_batch_data() {
+    QTest::addColumn<int>("implementation");
+
+    QTest::newRow("one by one") << -1;
+    QTest::newRow("scalar") << int(KQOAuthSha1::ScalarImplementation);
+    QTest::newRow("avx2") << int(KQOAuthSha1::Avx2Implementation);
+    QTest::newRow("sha-ni") << int(KQOAuthSha1::ShaNiImplementation);
+}
+
+void Bm_KQOAuth::bm_hmac_sha1_batch() {
+    QFETCH(int, implementation);
+
+    if (implementation >= 0 && !KQOAuthSha1::isSupported(KQOAuthSha1::Implementation(implementation))) {
+#if QT_VERSION >= 0x050000
+        QSKIP("Not supported by this CPU");
+#else
+        QSKIP("Not supported by this CPU", SkipSingle);
+#endif
+    }
+
+    // 256 base strings signed back to back with the same credentials.
+    QList<QByteArray> messages;
+    for (int i = 0; i < 256; i++) {
+        messages.append(baseString + QByteArray::number(i));
+    }
+    const QByteArray key = QUrl::toPercentEncoding(consumerSecret(0)) + "&" + QUrl::toPercentEncoding(tokenSecret(0));
+
+    if (implementation < 0) {
+        const QString keyString(key);
+        QBENCHMARK {
+            foreach (const QByteArray &message, messages) {
+                QString signature = KQOAuthUtils::hmac_sha1(message, keyString);
+                Q_UNUSED(signature);
+            }
+        }
+        return;
+    }
+
+    const int count = messages.size();
+    QVector<const char *> messageData(count);
+    QVector<int> messageLengths(count);
+    QVector<const char *> keys(count, key.constData());
+    QVector<int> keyLengths(count, key.size());
+    for (int i = 0; i < count; i++) {
+        messageData[i] = messages.at(i).constData();
+        messageLengths[i] = messages.at(i).size();
+    }
+    QByteArray digests(count * KQOAuthSha1::DigestSize, 0);
+
+    QBENCHMARK {
+        KQOAuthSha1::hmacBatch(messageData.constData(), messageLengths.constData(),
+                               keys.constData(), keyLengths.constData(), count,
+                               reinterpret_cast<uchar *>(digests.data()),
+                               KQOAuthSha1::Implementation(implementation));
+        QByteArray signatures = digests.toBase64();
+        Q_UNUSED(signatures);
+    }
+}
+
+void Bm_KQOAuth::bm_signature_encoding_data() {
+    QTest::addColumn<bool>("fused");
+
+    QTest::newRow("base64 + percent encoding") << false;
+    QTest::newRow("fused writer") << true;
+}
+
+// Signs the base string and appends the oauth_signature header fragment to 'header'.
+static void appendSignatureParam(QByteArray &header, const KQOAuthSigningContext &context,
+                                 const QByteArray &baseString, bool fused) {
+    header.append("oauth_signature=\"");
+    if (fused) {
+        uchar digest[KQOAuthSha1::DigestSize];
+        context.hmacSha1(baseString.constData(), baseString.size(), digest);
+
+        const int start = header.size();
+        header.resize(start + KQOAuthUtils::MaxPercentEncodedSha1Length);
+        header.resize(start + KQOAuthUtils::writePercentEncodedBase64(header.data() + start, digest,
+                                                                      KQOAuthSha1::DigestSize));
+    } else {
+        // What KQOAuthRequest::requestParameters() used to do.
+        QString signature = QString(context.hmacSha1(baseString).toBase64());
+        header.append(QString(QUrl::toPercentEncoding(signature)).toUtf8());
+    }
+    header.append('"');
+}
+
+void Bm_KQOAuth::bm_signature_encoding() {
+    QFETCH(bool, fused);
+
+    KQOAuthSigningContext context(consumerSecret(0), tokenSecret(0));
+    QByteArray header;
+    header.reserve(256);
+
+    QBENCHMARK {
+        header.resize(0);
+        appendSignatureParam(header, context, baseString, fused);
+    }
+
+    if (!AllocationCounter::isSupported()) {
+        return;
+    }
+
+    const int signatures = 1000;
+    AllocationCounter::start();
+    for (int i = 0; i < signatures; i++) {
+        header.resize(0);
+        appendSignatureParam(header, context, baseString, fused);
+    }
+    const int allocations = AllocationCounter::stop();
+
+    qDebug() << "Heap allocations per signature:" << double(allocations) / signatures;
+    if (fused) {
+        QCOMPARE(allocations, 0);
+    }
+}
+
+void Bm_KQOAuth::bm_percent_encoding_data() {
+    QTest::addColumn<int>("implementation");
+
+    QTest::newRow("QUrl") << -1;
+    QTest::newRow("scalar") << int(KQOAuthPercentEncoder::ScalarImplementation);
+    QTest::newRow("sse2") << int(KQOAuthPercentEncoder::Sse2Implementation);
+    QTest::newRow("avx2") << int(KQOAuthPercentEncoder::Avx2Implementation);
+}
+
+void Bm_KQOAuth::bm_percent_encoding() {
+    QFETCH(int, implementation);
+
+    if (implementation >= 0 && !KQOAuthPercentEncoder::isSupported(KQOAuthPercentEncoder::Implementation(implementation))) {
+#if QT_VERSION >= 0x050000
+        QSKIP("Not supported by this CPU");
+#else
+        QSKIP("Not supported by this CPU", SkipSingle);
+#endif
+    }
+
+    // A large form body value: mostly text, with a space or punctuation every few words.
+    QString value;
+    for (int i = 0; i < 2000; i++) {
+        value.append(QString("status%1 update, with_some-text.").arg(i));
+    }
+
+    if (implementation < 0) {
+        QBENCHMARK {
+            QByteArray encoded = QUrl::toPercentEncoding(value);
+            Q_UNUSED(encoded);
+        }
+        return;
+    }
+
+    const KQOAuthPercentEncoder::Implementation used = KQOAuthPercentEncoder::Implementation(implementation);
+    QBENCHMARK {
+        const QByteArray utf8 = value.toUtf8();
+        QByteArray encoded(KQOAuthPercentEncoder::encodedLength(utf8.constData(), utf8.size(), false, used),
+                           Qt::Uninitialized);
+        KQOAuthPercentEncoder::encode(encoded.data(), utf8.constData(), utf8.size(), false, used);
+        Q_UNUSED(encoded);
+    }
+}
+
+void Bm_KQOAuth::bm_base_string_parameters_data() {
+    QTest::addColumn<int>("parameterCount");
+    QTest::addColumn<bool>("builder");
+
+    const int counts[] = { 10, 100, 1000, 10000, 100000 };
+    for (unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        QTest::newRow(QString("%1 parameters, QString sort").arg(counts[i]).toLatin1().constData()) << counts[i] << false;
+        QTest::newRow(QString("%1 parameters, encoded byte sort").arg(counts[i]).toLatin1().constData()) << counts[i] << true;
+    }
+}
+
+// How KQOAuthRequestPrivate used to sort: four QString copies per comparison.
+static bool copyingParameterSort(const QPair<QString, QString> &left, const QPair<QString, QString> &right) {
+    QString keyLeft = left.first;
+    QString valueLeft = left.second;
+    QString keyRight = right.first;
+    QString valueRight = right.second;
+
+    if (keyLeft == keyRight) {
+        return (valueLeft < valueRight);
+    } else {
+        return (keyLeft < keyRight);
+    }
+}
+
+void Bm_KQOAuth::bm_base_string_parameters() {
+    QFETCH(int, parameterCount);
+    QFETCH(bool, builder);
+
+    // A bulk lookup: many "id" parameters plus the protocol parameters, in no particular order.
+    QList< QPair<QString, QString> > parameters;
+    for (int i = 0; i < parameterCount; i++) {
+        parameters.append(qMakePair(QString("id"), QString::number((i * 7919) % parameterCount)));
+    }
+    parameters.append(qMakePair(QString("oauth_consumer_key"), QString("9PqhX2sX7DlmjNJ5j2Q")));
+    parameters.append(qMakePair(QString("oauth_nonce"), QString("9275bae57071b54b6077a9d5561d45ad")));
+    parameters.append(qMakePair(QString("oauth_signature_method"), QString("HMAC-SHA1")));
+    parameters.append(qMakePair(QString("oauth_timestamp"), QString("1288513281")));
+    parameters.append(qMakePair(QString("oauth_version"), QString("1.0")));
+
+    const QString endpoint("http://api.twitter.com/1/users/lookup.json");
+
+    if (builder) {
+        QBENCHMARK {
+            QByteArray baseString = KQOAuthBaseStringBuilder::build("GET", endpoint, parameters);
+            Q_UNUSED(baseString);
+        }
+        return;
+    }
+
+    QBENCHMARK {
+        QList< QPair<QString, QString> > sorted = parameters;
+        qSort(sorted.begin(), sorted.end(), copyingParameterSort);
+
+        QByteArray parameterList;
+        for (int i = 0; i < sorted.size(); i++) {
+            if (i > 0) {
+                parameterList.append("&");
+            }
+            parameterList.append(QUrl::toPercentEncoding(sorted.at(i).first) + "="
+                                 + QUrl::toPercentEncoding(sorted.at(i).second));
+        }
+        QByteArray baseString = "GET&" + QUrl::toPercentEncoding(endpoint) + "&" + QUrl::toPercentEncoding(parameterList);
+        Q_UNUSED(baseString);
+    }
+}
+
+void Bm_KQOAuth::bm_protocol_keys_startup_data() {
+    QTest::addColumn<bool>("latin1");
+
+    QTest::newRow("const QString globals") << false;
+    QTest::newRow("const QLatin1String globals") << true;
+}
+
+// What static initialisation of kqoauthglobals.h costs every translation unit that includes it,
+// measured as constructing and destroying the eleven protocol keys.
+void Bm_KQOAuth::bm_protocol_keys_startup() {
+    QFETCH(bool, latin1);
+
+    static const char * const keys[] = {
+        "oauth_consumer", "oauth_consumer_key", "oauth_token", "oauth_token_secret",
+        "oauth_signature_method", "oauth_timestamp", "oauth_nonce", "oauth_signature",
+        "oauth_callback", "oauth_verifier", "oauth_version"
+    };
+    const int keyCount = sizeof(keys) / sizeof(keys[0]);
+
+    int allocations = 0;
+    if (latin1) {
+        QBENCHMARK {
+            for (int i = 0; i < keyCount; i++) {
+                const QLatin1String key(keys[i]);
+                Q_UNUSED(key);
+            }
+        }
+        AllocationCounter::start();
+        const QLatin1String key(keys[0]);
+        Q_UNUSED(key);
+        allocations = AllocationCounter::stop();
+    } else {
+        QBENCHMARK {
+            for (int i = 0; i < keyCount; i++) {
+                const QString key(keys[i]);
+                Q_UNUSED(key);
+            }
+        }
+        AllocationCounter::start();
+        const QString key(keys[0]);
+        Q_UNUSED(key);
+        allocations = AllocationCounter::stop();
+    }
+
+    if (AllocationCounter::isSupported()) {
+        qDebug() << "Heap allocations per translation unit:" << allocations * keyCount;
+        if (latin1) {
+            QCOMPARE(allocations, 0);
+        }
+    }
+}
+
+void Bm_KQOAuth::bm_request_template_data() {
+    QTest::addColumn<int>("fixedCount");
+    QTest::addColumn<bool>("useTemplate");
+
+    const int counts[] = { 5, 50, 500 };
+    for (unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        QTest::newRow(QString("%1 fixed parameters, plain request").arg(counts[i]).toLatin1().constData()) << counts[i] << false;
+        QTest::newRow(QString("%1 fixed parameters, request template").arg(counts[i]).toLatin1().constData()) << counts[i] << true;
+    }
+}
+
+// The cost of signing one authorized request when most of its parameters are the same every time.
+void Bm_KQOAuth::bm_request_template() {
+    QFETCH(int, fixedCount);
+    QFETCH(bool, useTemplate);
+
+    const KQOAuthEndpoint endpoint(QUrl("http://api.example.com/1/statuses/home_timeline.json"));
+    const QString consumerKey("9PqhX2sX7DlmjNJ5j2Q");
+    const QString token("15865443-RfO7YFnKuUs6JdXSSsb6gPASfx3aqSjtoIjSgT5CY");
+    const QString consumerSecretKey = consumerSecret(0);
+    const QString tokenSecretKey = tokenSecret(0);
+
+    KQOAuthParameters fixedParameters;
+    for (int i = 0; i < fixedCount; i++) {
+        fixedParameters.insert(QString("filter_%1").arg(i), QString("value %1").arg(i));
+    }
+    KQOAuthParameters changingParameters;
+    changingParameters.insert("page", "2");
+
+    KQOAuthParameters allParameters = fixedParameters;
+    allParameters += changingParameters;
+
+    const KQOAuthRequestTemplate requestTemplate(endpoint, consumerKey, token, fixedParameters);
+
+    KQOAuthRequest request;
+    if (useTemplate) {
+        QBENCHMARK {
+            request.initRequest(requestTemplate);
+            request.setConsumerSecretKey(consumerSecretKey);
+            request.setTokenSecret(tokenSecretKey);
+            request.setAdditionalParameters(changingParameters);
+            QList<QByteArray> header = request.requestParameters();
+            Q_UNUSED(header);
+        }
+        return;
+    }
+
+    QBENCHMARK {
+        request.initRequest(KQOAuthRequest::AuthorizedRequest, endpoint);
+        request.setConsumerKey(consumerKey);
+        request.setConsumerSecretKey(consumerSecretKey);
+        request.setToken(token);
+        request.setTokenSecret(tokenSecretKey);
+        request.setAdditionalParameters(allParameters);
+        QList<QByteArray> header = request.requestParameters();
+        Q_UNUSED(header);
+    }
+}
+
+void Bm_KQOAuth::bm_request_memory_data() {
+    QTest::addColumn<bool>("valueType");
+    QTest::addColumn<bool>("sharedCredentials");
+
+    QTest::newRow("KQOAuthRequest") << false << false;
+    QTest::newRow("KQOAuthRequest, KQOAuthCredentials") << false << true;
+    QTest::newRow("KQOAuthRequestData") << true << false;
+    QTest::newRow("KQOAuthRequestData, KQOAuthCredentials") << true << true;
+}
+
+// Heap use of requests queued in memory before they are sent. The credentials are the same
+// QStrings for every request, as they are in an application.
+void Bm_KQOAuth::bm_request_memory() {
+    QFETCH(bool, valueType);
+    QFETCH(bool, sharedCredentials);
+
+    const int requestCount = 10000;
+    const KQOAuthEndpoint endpoint(QUrl("http://api.example.com/1/statuses/show.json"));
+    const QString consumerKey("9PqhX2sX7DlmjNJ5j2Q");
+    const QString consumerSecretKey = consumerSecret(0);
+    const QString token("15865443-RfO7YFnKuUs6JdXSSsb6gPASfx3aqSjtoIjSgT5CY");
+    const QString tokenSecretKey = tokenSecret(0);
+    const QString idKey("id");
+    const KQOAuthCredentials credentials(consumerKey, consumerSecretKey, token, tokenSecretKey);
+
+    int allocations = 0;
+    qint64 bytes = 0;
+    if (valueType) {
+        QBENCHMARK {
+            QList<KQOAuthRequestData> requests;
+            AllocationCounter::start();
+            for (int i = 0; i < requestCount; i++) {
+                KQOAuthRequestData request(KQOAuthRequest::AuthorizedRequest, endpoint);
+                request.setHttpMethod(KQOAuthRequest::GET);
+                if (sharedCredentials) {
+                    request.setCredentials(credentials);
+                } else {
+                    request.setConsumerKey(consumerKey);
+                    request.setConsumerSecretKey(consumerSecretKey);
+                    request.setToken(token);
+                    request.setTokenSecret(tokenSecretKey);
+                }
+                request.addAdditionalParameter(idKey, QString::number(i));
+                requests.append(request);
+            }
+            allocations = AllocationCounter::stop();
+            bytes = AllocationCounter::allocatedBytes();
+        }
+    } else {
+        QBENCHMARK {
+            QList<KQOAuthRequest *> requests;
+            AllocationCounter::start();
+            for (int i = 0; i < requestCount; i++) {
+                KQOAuthRequest *request = new KQOAuthRequest;
+                request->initRequest(KQOAuthRequest::AuthorizedRequest, endpoint);
+                request->setHttpMethod(KQOAuthRequest::GET);
+                if (sharedCredentials) {
+                    request->setCredentials(credentials);
+                } else {
+                    request->setConsumerKey(consumerKey);
+                    request->setConsumerSecretKey(consumerSecretKey);
+                    request->setToken(token);
+                    request->setTokenSecret(tokenSecretKey);
+                }
+                KQOAuthParameters parameters;
+                parameters.insert(idKey, QString::number(i));
+                request->setAdditionalParameters(parameters);
+                requests.append(request);
+            }
+            allocations = AllocationCounter::stop();
+            bytes = AllocationCounter::allocatedBytes();
+            qDeleteAll(requests);
+        }
+    }
+
+    if (AllocationCounter::isSupported()) {
+        qDebug() << "Heap allocations per request:" << double(allocations) / requestCount
+                 << "bytes per request:" << double(bytes) / requestCount;
+    }
+}
+
+void Bm_KQOAuth::bm_signing_allocations_data() {
+    QTest::addColumn<int>("parameterCount");
+
+    QTest::newRow("1 parameter") << 1;
+    QTest::newRow("8 parameters") << 8;
+    QTest::newRow("64 parameters") << 64;
+}
+
+// Heap allocations made by signing an authorized request. Everything but the header fragments
+// handed back is made in the arena of requestParameters().
+void Bm_KQOAuth::bm_signing_allocations() {
+    QFETCH(int, parameterCount);
+
+    KQOAuthParameters parameters;
+    for (int i = 0; i < parameterCount; i++) {
+        parameters.insert(QString("parameter_%1").arg(i), QString("value %1").arg(i));
+    }
+
+    KQOAuthRequest request;
+    request.initRequest(KQOAuthRequest::AuthorizedRequest, QUrl("http://api.example.com/1/statuses/update.json"));
+    request.setConsumerKey("9PqhX2sX7DlmjNJ5j2Q");
+    request.setConsumerSecretKey(consumerSecret(0));
+    request.setToken("15865443-RfO7YFnKuUs6JdXSSsb6gPASfx3aqSjtoIjSgT5CY");
+    request.setTokenSecret(tokenSecret(0));
+    request.setAdditionalParameters(parameters);
+
+    // The first signature makes the signing context, which later ones share.
+    QList<QByteArray> header = request.requestParameters();
+
+    QBENCHMARK {
+        request.setVerifier(QString());
+        header = request.requestParameters();
+    }
+
+    if (!AllocationCounter::isSupported()) {
+        return;
+    }
+
+    request.setVerifier(QString());
+    AllocationCounter::start();
+    header = request.requestParameters();
+    const int allocations = AllocationCounter::stop();
+
+    qDebug() << "Heap allocations per signature:" << allocations;
+    // One per header fragment and one for the list, and at most one more arena block for
+    // requests with many parameters.
+    QVERIFY(allocations <= header.size() + 2);
+}
+
+void Bm_KQOAuth::bm_fixed_protocol_layout_data() {
+    QTest::addColumn<int>("parameterCount");
+    QTest::addColumn<bool>("fixedLayout");
+
+    const int counts[] = { 0, 1, 8 };
+    for (unsigned i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        QTest::newRow(QString("%1 parameters, KQOAuthRequest").arg(counts[i]).toLatin1().constData()) << counts[i] << false;
+        QTest::newRow(QString("%1 parameters, KQOAuthRequest_1").arg(counts[i]).toLatin1().constData()) << counts[i] << true;
+    }
+}
+
+// Signing the same authorized request again after a setter, with the protocol parameters
+// appended to a list or written to the fixed slots of KQOAuthRequest_1.
+void Bm_KQOAuth::bm_fixed_protocol_layout() {
+    QFETCH(int, parameterCount);
+    QFETCH(bool, fixedLayout);
+
+    KQOAuthParameters parameters;
+    for (int i = 0; i < parameterCount; i++) {
+        parameters.insert(QString("parameter_%1").arg(i), QString("value %1").arg(i));
+    }
+
+    KQOAuthRequest plainRequest;
+    KQOAuthRequest_1 fixedRequest;
+    KQOAuthRequest &request = fixedLayout ? fixedRequest : plainRequest;
+    request.initRequest(KQOAuthRequest::AuthorizedRequest, QUrl("http://api.example.com/1/statuses/update.json"));
+    request.setConsumerKey("9PqhX2sX7DlmjNJ5j2Q");
+    request.setConsumerSecretKey(consumerSecret(0));
+    request.setToken("15865443-RfO7YFnKuUs6JdXSSsb6gPASfx3aqSjtoIjSgT5CY");
+    request.setTokenSecret(tokenSecret(0));
+    request.setAdditionalParameters(parameters);
+
+    // The first signature makes the signing context and lays out the slots.
+    QByteArray header = request.authorizationHeader();
+
+    QBENCHMARK {
+        request.setVerifier(QString());
+        header = request.authorizationHeader();
+    }
+
+    if (AllocationCounter::isSupported()) {
+        request.setVerifier(QString());
+        AllocationCounter::start();
+        header = request.authorizationHeader();
+        qDebug() << "Heap allocations per signature:" << AllocationCounter::stop();
+    }
+}
+
+QTEST_MAIN(Bm_KQOAuth)
@@ -0,0 +1,61 @@
+/**
+ * KQOAuth - An OAuth authentication library for Qt.
+ *
+ * Author: Johan Paul (johan.paul@d-pointer.com)
+ *         http://www.d-pointer.com
+ *
+ *  KQOAuth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  KQOAuth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with KQOAuth.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef BM_KQOAUTH_H
+#define BM_KQOAUTH_H
+
+#include <QObject>
+
+class Bm_KQOAuth : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void bm_hmac_sha1_data();
+    void bm_hmac_sha1();
+    void bm_hmac_sha1_signing_context_data();
+    void bm_hmac_sha1_signing_context();
+    void bm_hmac_sha1_backend_data();
+    void bm_hmac_sha1_backend();
+    void bm_hmac_sha1_bytes_data();
+    void bm_hmac_sha1_bytes();
+    void bm_hmac_sha1_batch_data();
+    void bm_hmac_sha1_batch();
+    void bm_signature_encoding_data();
+    void bm_signature_encoding();
+    void bm_percent_encoding_data();
+    void bm_percent_encoding();
+    void bm_base_string_parameters_data();
+    void bm_base_string_parameters();
+    void bm_protocol_keys_startup_data();
+    void bm_protocol_keys_startup();
+    void bm_request_template_data();
+    void bm_request_template();
+    void bm_request_memory_data();
+    void bm_request_memory();
+    void bm_signing_allocations_data();
+    void bm_signing_allocations();
+    void bm_fixed_protocol_layout_data();
+    void bm_fixed_protocol_layout();
+
+private:
+    static const QByteArray baseString;
+};
+
+#endif // BM_KQOAUTH_H
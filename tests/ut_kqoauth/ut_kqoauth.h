@@ -35,12 +35,49 @@ private Q_SLOTS:
 
     void ut_requestBaseString_data();
     void ut_requestBaseString();
+    void ut_base_string_builder_data();
+    void ut_base_string_builder();
+    void ut_base_string_sort_order();
+    void ut_endpoint_data();
+    void ut_endpoint();
+    void ut_request_template();
+    void ut_body_hash();
+    void ut_request_data();
+    void ut_credentials();
+    void ut_signing_cache();
+    void ut_authorization_header();
+    void ut_parameter_list();
+    void ut_form_parameters_encoded_once();
+    void ut_intern_table();
+    void ut_arena();
+    void ut_request_pool();
+    void ut_fixed_protocol_layout_data();
+    void ut_fixed_protocol_layout();
     void ut_hmac_sha1_data();
     void ut_hmac_sha1();
+    void ut_hmac_sha1_backends_data();
+    void ut_hmac_sha1_backends();
+    void ut_hmac_sha1_batch_data();
+    void ut_hmac_sha1_batch();
     void ut_random_nonce();
     void ut_basestring_with_percent_encoding();
     void ut_basestring_with_percent_encoding_data();
     void ut_convert_verifier();
+    void ut_signing_context_data();
+    void ut_signing_context();
+    void ut_rsa_sha1();
+    void ut_rsa_sha1_invalid_key();
+    void ut_rsa_key_cache_eviction();
+    void ut_sign_utf8_bytes();
+    void ut_signature_methods();
+    void ut_signature_method_names_data();
+    void ut_signature_method_names();
+    void ut_rsa_signing_queue();
+    void ut_rsa_signing_limit();
+    void ut_percent_encoded_base64_data();
+    void ut_percent_encoded_base64();
+    void ut_percent_encoder_data();
+    void ut_percent_encoder();
 
 private:
     KQOAuthRequest *r;
@@ -48,6 +85,7 @@ private:
 
     static const QString twitterExampleBaseString;
     static const QString googleBaseString;
+    static const QString rsaPrivateKey;
 
 };
 